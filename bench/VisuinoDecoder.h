@@ -0,0 +1,58 @@
+// Host stand-in for the Visuino end of the binary serial link, see WebsiteServer::Visuino for the frame layout.
+// Bytes are fed as they come off the wire, poll() hands out frames with a good CRC and resynchronizes on garbage.
+
+#include <cstring>
+
+namespace Bench {
+  class VisuinoFrameDecoder {
+  public:
+    void feed(uint8_t byte) {
+      if (length == sizeof(buffer)) drop(1);
+      buffer[length++] = byte;
+    }
+
+    bool poll(WebsiteServer::Visuino::Event& event) {
+      using namespace WebsiteServer::Visuino;
+      while (length > 0) {
+        if (buffer[0] != FrameSync) {
+          drop(1);
+          continue;
+        }
+        if (length < FrameHeaderSize) return false;
+        uint8_t size = valueSize(static_cast<TypeTag>(buffer[3]));
+        if (size == 0) {
+          drop(1);
+          continue;
+        }
+        size_t total = FrameHeaderSize + size + FrameCrcSize;
+        if (length < total) return false;
+        uint16_t crc = static_cast<uint16_t>(buffer[total - 2] | (buffer[total - 1] << 8));
+        if (crc != crc16(buffer + 1, FrameHeaderSize - 1 + size)) {
+          crcErrors++;
+          drop(1);
+          continue;
+        }
+        event.id = static_cast<uint16_t>(buffer[1] | (buffer[2] << 8));
+        event.type = static_cast<TypeTag>(buffer[3]);
+        event.value = 0;
+        for (uint8_t i = 0; i < size; i++) event.value |= static_cast<uint32_t>(buffer[FrameHeaderSize + i]) << (8 * i);
+        drop(total);
+        frames++;
+        return true;
+      }
+      return false;
+    }
+
+    uint32_t crcErrors = 0;
+    uint32_t frames = 0;
+
+  private:
+    void drop(size_t count) {
+      memmove(buffer, buffer + count, length - count);
+      length -= count;
+    }
+
+    uint8_t buffer[WebsiteServer::Visuino::MaxFrameSize];
+    size_t length = 0;
+  };
+}
@@ -0,0 +1,2554 @@
+// Host benchmark for the layout loader and the HTTP handlers, built by [env:native]:
+//   pio run -e native && .pio/build/native/program [sizes...]
+// main.cpp is compiled into this translation unit, so everything runs through the same code as on the device.
+// Every layout size runs in its own forked process, the loader keeps its state in statics and the heap peak has to start clean.
+
+#include "../src/main.cpp"
+#include "VisuinoDecoder.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+extern "C" void* __real_malloc(size_t size);
+extern "C" void __real_free(void* ptr);
+
+namespace Bench {
+  using namespace WebsiteServer;
+
+  const uint16_t DefaultIterations = 200;
+
+  struct Result {
+    size_t components;
+    size_t jsonBytes;
+    double parseUs;
+    double inputUs;
+    size_t inputBytes;
+    size_t inputPeak;
+    double statusUs;
+    double deltaUs;
+    size_t deltaBytes;
+    size_t peakHeap;
+  };
+
+  // runs fn in a forked child, see the definition at the end of the namespace
+  template <typename Fn> bool isolated(Fn fn);
+
+  // micros() is too coarse for single requests on a host CPU
+  double nowUs() {
+    auto now = std::chrono::steady_clock::now().time_since_epoch();
+    return std::chrono::duration<double, std::micro>(now).count();
+  }
+
+  // Pulls the response like AsyncTCP does but throws the bytes away, so the measured heap is the server's own
+  size_t discard(AsyncWebServerResponse* response, size_t segmentSize = 1436) {
+    if (response == nullptr) return 0;
+    std::vector<uint8_t> segment(segmentSize);
+    size_t total = 0;
+    uint32_t retries = 0;
+    while (true) {
+      size_t written = response->fill(segment.data(), segmentSize, total);
+      if (written == RESPONSE_TRY_AGAIN) {
+        if (++retries > 1000) break;
+        continue;
+      }
+      if (written == 0) break;
+      total += written;
+    }
+    return total;
+  }
+
+  // Layout of `count` components, built by cycling through the elements of testWebsiteConfigStr with unique names
+  String generateLayout(size_t count) {
+    DynamicJsonDocument templateDoc(testWebsiteConfigStr.length() * 2);
+    deserializeJson(templateDoc, testWebsiteConfigStr);
+    JsonArrayConst elements = templateDoc[JsonKey::Elements].as<JsonArrayConst>();
+    String layout;
+    layout.reserve(count * 200);
+    layout += "{\"elements\":[";
+    String element;
+    for (size_t i = 0; i < count; i++) {
+      JsonObjectConst source = elements[i % elements.size()];
+      element.clear();
+      serializeJson(source, element);
+      String name = source[JsonKey::Name].as<String>();
+      String from = String("\"name\":\"") + name + "\"";
+      String to = String("\"name\":\"") + name + "_" + String(static_cast<unsigned long>(i)) + "\"";
+      int at = element.indexOf(from);
+      if (i > 0) layout += ',';
+      if (at < 0) {
+        layout += element;
+        continue;
+      }
+      layout += element.substring(0, at);
+      layout += to;
+      layout += element.substring(at + from.length());
+    }
+    layout += "]}";
+    return layout;
+  }
+
+  // /status bodies for every input component of the generated layout
+  std::vector<String> statusBodies(const String& layout) {
+    std::vector<String> bodies;
+    DynamicJsonDocument doc(layout.length() * 2);
+    deserializeJson(doc, layout);
+    uint32_t toggle = 0;
+    for (JsonObjectConst element : doc[JsonKey::Elements].as<JsonArrayConst>()) {
+      const char* type = element[JsonKey::ComponentType];
+      if (type == nullptr) continue;
+      String body = String("{\"name\":\"") + element[JsonKey::Name].as<const char*>() + "\",\"componentType\":\"" + type + "\",\"value\":";
+      if (!strcmp(type, ComponentType::Input::Switch) || !strcmp(type, ComponentType::Input::Button)) {
+        body += (toggle++ & 1) ? "true" : "false";
+      } else if (!strcmp(type, ComponentType::Input::Slider)) {
+        body += String(static_cast<unsigned long>(toggle++ % 800));
+      } else if (!strcmp(type, ComponentType::Input::NumberInput)) {
+        body += String(toggle++ * 0.5);
+      } else continue;
+      body += "}";
+      bodies.push_back(body);
+    }
+    return bodies;
+  }
+
+  Result run(size_t count, uint16_t iterations) {
+    Result result = {};
+    result.components = count;
+    WebsiteServer::ServerInit();
+    String layout = generateLayout(count);
+    std::vector<String> bodies = statusBodies(layout);
+    result.jsonBytes = layout.length();
+    NativeHeap::resetPeak();
+
+    double start = nowUs();
+    JsonReader::InputJsonStatus status = JsonReader::readWebsiteComponentsFromJson(layout);
+    result.parseUs = nowUs() - start;
+    if (status != JsonReader::InputJsonStatus::OK) {
+      fprintf(stderr, "%zu components: %s\n", count, JsonReader::errorHandler(status));
+    }
+    loop();
+
+    size_t loadPeak = NativeHeap::peak();
+    double total = 0;
+    size_t baseline = NativeHeap::used();
+    NativeHeap::resetPeak();
+    for (uint16_t i = 0; i < iterations; i++) {
+      AsyncWebServerRequest request(HTTP_GET, "/input");
+      start = nowUs();
+      server.handle(request);
+      result.inputBytes = discard(request.response());
+      total += nowUs() - start;
+      loop();
+    }
+    result.inputUs = total / iterations;
+    result.inputPeak = NativeHeap::peak() - baseline;
+
+    total = 0;
+    for (uint16_t i = 0; i < iterations && !bodies.empty(); i++) {
+      // spread over the whole layout, the lookup cost depends on where the component sits
+      const String& body = bodies[(i * 7919u) % bodies.size()];
+      AsyncWebServerRequest request(HTTP_POST, "/status");
+      start = nowUs();
+      server.handle(request, reinterpret_cast<const uint8_t*>(body.c_str()), body.length());
+      total += nowUs() - start;
+      loop();
+    }
+    result.statusUs = total / iterations;
+
+    // dashboard polling: one component changes between two /input?since= requests
+    total = 0;
+    for (uint16_t i = 0; i < iterations && !bodies.empty(); i++) {
+      uint32_t since = card.getVersion();
+      const String& body = bodies[(i * 7919u + 1) % bodies.size()];
+      AsyncWebServerRequest statusRequest(HTTP_POST, "/status");
+      server.handle(statusRequest, reinterpret_cast<const uint8_t*>(body.c_str()), body.length());
+      loop();
+      AsyncWebServerRequest request(HTTP_GET, String("/input?since=") + String(static_cast<unsigned long>(since)));
+      start = nowUs();
+      server.handle(request);
+      result.deltaBytes = discard(request.response());
+      total += nowUs() - start;
+    }
+    result.deltaUs = total / iterations;
+    result.peakHeap = std::max(loadPeak, NativeHeap::peak());
+    return result;
+  }
+
+  struct EventsResult {
+    size_t clients;
+    double pushUs;
+    double publishUs;
+    size_t heapPerClient;
+    size_t queuedHeap;
+    uint32_t eventsPerClient;
+    uint32_t dropped;
+  };
+
+  // Visuino updates of gauges and progress bars from the generated layout, the way they arrive through readWebsiteComponentsFromJson
+  std::vector<String> outputUpdates(const String& layout, uint32_t value) {
+    std::vector<String> updates;
+    DynamicJsonDocument doc(layout.length() * 2);
+    deserializeJson(doc, layout);
+    for (JsonObjectConst element : doc[JsonKey::Elements].as<JsonArrayConst>()) {
+      const char* type = element[JsonKey::ComponentType];
+      if (type == nullptr || (strcmp(type, ComponentType::Output::Gauge) && strcmp(type, ComponentType::Output::ProgressBar))) continue;
+      updates.push_back(String("{\"elements\":[{\"name\":\"") + element[JsonKey::Name].as<const char*>() +
+                        "\",\"componentType\":\"" + type + "\",\"value\":" + String(static_cast<unsigned long>(value)) + "}]}");
+    }
+    return updates;
+  }
+
+  uint32_t drainEvents() {
+    uint32_t received = 0;
+    for (auto& client : events.clients()) received += client->drain().size();
+    return received;
+  }
+
+  // Push channel: a Visuino update of one output until its event sits in every client's queue
+  EventsResult runEvents(size_t clients, uint16_t iterations) {
+    EventsResult result = {};
+    result.clients = clients;
+    WebsiteServer::ServerInit();
+    String layout = generateLayout(100);
+    JsonReader::readWebsiteComponentsFromJson(layout);
+    loop();
+
+    size_t before = NativeHeap::used();
+    for (size_t i = 0; i < clients; i++) events.connect();
+    result.heapPerClient = (NativeHeap::used() - before) / clients;
+    drainEvents();
+
+    double pushTotal = 0;
+    double publishTotal = 0;
+    uint32_t received = 0;
+    for (uint16_t i = 0; i < iterations; i++) {
+      std::vector<String> updates = outputUpdates(layout, i + 1);
+      const String& update = updates[i % updates.size()];
+      size_t queuedBefore = NativeHeap::used();
+      double start = nowUs();
+      JsonReader::readWebsiteComponentsFromJson(update);
+      double published = nowUs();
+      loop();
+      double end = nowUs();
+      pushTotal += end - start;
+      publishTotal += end - published;
+      if (NativeHeap::used() > queuedBefore) result.queuedHeap = std::max(result.queuedHeap, NativeHeap::used() - queuedBefore);
+      received += drainEvents();
+    }
+    result.pushUs = pushTotal / iterations;
+    result.publishUs = publishTotal / iterations;
+    result.eventsPerClient = received / clients;
+    for (auto& client : events.clients()) result.dropped += client->dropped();
+    return result;
+  }
+
+  // Ten updates of one gauge between two ticks reach each client as one event with the last value
+  bool checkEventCoalescing() {
+    WebsiteServer::ServerInit();
+    String layout = generateLayout(40);
+    JsonReader::readWebsiteComponentsFromJson(layout);
+    loop();
+    AsyncEventSourceClient* client = events.connect();
+    client->drain();
+    for (uint32_t value = 1; value <= 10; value++) JsonReader::readWebsiteComponentsFromJson(outputUpdates(layout, value)[0]);
+    loop();
+    std::vector<String> received = client->drain();
+    if (received.size() != 1 || received[0].indexOf("\"value\":10") < 0) {
+      fprintf(stderr, "events: expected one coalesced event, got %zu\n", received.size());
+      return false;
+    }
+    return true;
+  }
+
+  struct InputChannelResult {
+    uint32_t messages;
+    double statusPerSecond;
+    uint64_t statusForwarded;
+    double wsPerSecond;
+    uint64_t wsForwarded;
+  };
+
+  // Slider drags: `perTick` values for each of the layout's sliders between two loop() ticks, once as /status POSTs, once over /ws.
+  // The host stand-ins skip TCP setup and header parsing, so /status gets away cheaper than on the device.
+  InputChannelResult runInputChannels(uint16_t ticks, uint16_t perTick) {
+    InputChannelResult result = {};
+    WebsiteServer::ServerInit();
+    String layout = generateLayout(100);
+    JsonReader::readWebsiteComponentsFromJson(layout);
+    loop();
+    std::vector<String> sliders;
+    DynamicJsonDocument doc(layout.length() * 2);
+    deserializeJson(doc, layout);
+    for (JsonObjectConst element : doc[JsonKey::Elements].as<JsonArrayConst>()) {
+      const char* type = element[JsonKey::ComponentType];
+      if (type != nullptr && !strcmp(type, ComponentType::Input::Slider)) sliders.push_back(element[JsonKey::Name].as<const char*>());
+    }
+    auto message = [&sliders] (size_t slider, uint32_t value) {
+      return String("{\"name\":\"") + sliders[slider] + "\",\"componentType\":\"slider\",\"value\":" + String(static_cast<unsigned long>(value)) + "}";
+    };
+
+    Serial.resetCounters();
+    double start = nowUs();
+    for (uint16_t tick = 0; tick < ticks; tick++) {
+      for (uint16_t i = 0; i < perTick; i++) {
+        for (size_t slider = 0; slider < sliders.size(); slider++) {
+          String body = message(slider, tick * perTick + i);
+          AsyncWebServerRequest request(HTTP_POST, "/status");
+          server.handle(request, reinterpret_cast<const uint8_t*>(body.c_str()), body.length());
+          result.messages++;
+        }
+      }
+      loop();
+    }
+    result.statusPerSecond = result.messages / ((nowUs() - start) / 1e6);
+    result.statusForwarded = Serial.linesWritten();
+
+    AsyncWebSocketClient* client = ws.connect();
+    Serial.resetCounters();
+    start = nowUs();
+    for (uint16_t tick = 0; tick < ticks; tick++) {
+      for (uint16_t i = 0; i < perTick; i++) {
+        for (size_t slider = 0; slider < sliders.size(); slider++) {
+          String body = message(slider, tick * perTick + i);
+          ws.receive(client, reinterpret_cast<const uint8_t*>(body.c_str()), body.length());
+        }
+      }
+      loop();
+    }
+    result.wsPerSecond = result.messages / ((nowUs() - start) / 1e6);
+    result.wsForwarded = Serial.linesWritten();
+    return result;
+  }
+
+  // /status messages for every input of a generated layout, the value derived from `round`
+  std::vector<String> inputMessages(const String& layout, uint32_t round) {
+    std::vector<String> messages;
+    DynamicJsonDocument doc(layout.length() * 2);
+    deserializeJson(doc, layout);
+    for (JsonObjectConst element : doc[JsonKey::Elements].as<JsonArrayConst>()) {
+      const char* type = element[JsonKey::ComponentType];
+      String value;
+      if (!strcmp(type, ComponentType::Input::Slider)) value = String(static_cast<unsigned long>(round % 100));
+      else if (!strcmp(type, ComponentType::Input::NumberInput)) value = String(round % 1000) + ".5";
+      else if (!strcmp(type, ComponentType::Input::Switch) || !strcmp(type, ComponentType::Input::Button)) value = round % 2 ? "true" : "false";
+      else continue;
+      messages.push_back(String("{\"name\":\"") + element[JsonKey::Name].as<const char*>() + "\",\"componentType\":\"" + type +
+                         "\",\"value\":" + value + "}");
+    }
+    return messages;
+  }
+
+  // /ws updates for every input between two loop() ticks: queueing them for loop() must not allocate, the pending list has room
+  // for every input from the layout load on, so the async TCP task never allocates while holding the lock loop() spins on.
+  // The same messages sent again find every input pending already, they give what the stand-ins allocate on their own.
+  bool checkPendingRoom() {
+    WebsiteServer::ServerInit();
+    String layout = generateLayout(100);
+    JsonReader::readWebsiteComponentsFromJson(layout);
+    loop();
+    AsyncWebSocketClient* client = ws.connect();
+    bool ok = true;
+    for (uint32_t round = 1; round <= 3; round++) {
+      std::vector<String> messages = inputMessages(layout, round);
+      uint32_t made[2];
+      for (uint32_t& pass : made) {
+        uint32_t allocations = NativeHeap::allocations();
+        for (const String& body : messages) ws.receive(client, reinterpret_cast<const uint8_t*>(body.c_str()), body.length());
+        pass = NativeHeap::allocations() - allocations;
+      }
+      if (made[0] != made[1]) {
+        fprintf(stderr, "pending inputs: %u allocations queueing %zu /ws updates in round %u\n", made[0] - made[1], messages.size(), round);
+        ok = false;
+      }
+      loop();
+    }
+    return ok;
+  }
+
+  String batchBody(const std::vector<String>& messages, size_t first, size_t count) {
+    String body("[");
+    for (size_t i = 0; i < count; i++) {
+      if (i > 0) body += ',';
+      body += messages[(first + i) % messages.size()];
+    }
+    return body + "]";
+  }
+
+  String replyOf(AsyncWebServerRequest& request) {
+    return request.response() != nullptr ? String(request.response()->code()) + " " + request.response()->drain() : String();
+  }
+
+  String postStatus(const String& body) {
+    AsyncWebServerRequest request(HTTP_POST, "/status");
+    server.handle(request, reinterpret_cast<const uint8_t*>(body.c_str()), body.length());
+    return replyOf(request);
+  }
+
+  // Per-message results of a /status batch, its events queued back to back in message order, the batch limit and the
+  // single message form still answered as before
+  bool checkStatusBatch() {
+    WebsiteServer::ServerInit();
+    String layout = generateLayout(40);
+    JsonReader::readWebsiteComponentsFromJson(layout);
+    loop();
+    std::vector<String> messages = inputMessages(layout, 7);
+    bool ok = true;
+    auto expect = [&ok] (bool condition, const char* what) {
+      if (!condition) fprintf(stderr, "status batch: %s\n", what);
+      ok &= condition;
+    };
+    String body = String("[") + messages[0] + ",{\"name\":\"nothing\",\"componentType\":\"slider\",\"value\":1}," +
+                  "{\"name\":\"Info_8\",\"componentType\":\"label\",\"value\":\"x\"}," + messages[1] + "," + messages[0] + "]";
+    expect(postStatus(body) == "200 [200,400,400,200,200]", "per message results");
+    std::vector<Visuino::Event> queued;
+    Visuino::Event event;
+    while (Visuino::queue.pop(event)) queued.push_back(event);
+    Website::WebsiteComponent* first = nullptr;
+    for (uint16_t id = 0; (first = card.getComponentById(id)) != nullptr; id++) {
+      if (messages[0].indexOf(String("\"") + first->getName() + "\"") >= 0) break;
+    }
+    expect(queued.size() == 3 && first != nullptr && queued[0].id == first->getId() && queued[2].id == first->getId(), "queued events");
+
+    String results = postStatus(batchBody(messages, 0, Website::Card::MaxStatusBatch + 2));
+    expect(results.startsWith("200 [200,") && results.endsWith(",200,413,413]"), "batch limit");
+    size_t forwarded = 0;
+    while (Visuino::queue.pop(event)) forwarded++;
+    while (Visuino::queue.takeOverflow()) {
+      Website::WebsiteComponent* component;
+      for (uint16_t id = 0; (component = card.getComponentById(id)) != nullptr; id++) {
+        uint32_t value;
+        Website::InputComponent* input = component->asInput();
+        if (input != nullptr && Visuino::queue.takeParked(input->getOverflowSlot(), value)) forwarded++;
+      }
+    }
+    expect(forwarded > 0 && forwarded <= Website::Card::MaxStatusBatch, "events past the limit forwarded");
+
+    expect(postStatus(String("[") + messages[2] + ",{\"name\":]") == "200 [200,400]", "truncated message ends the batch");
+    while (Visuino::queue.pop(event)) {}
+    // malformed messages in the middle, with brackets and commas inside their strings and arrays, cost only themselves
+    body = String("[") + messages[4] + ",{\"name\":\"a],[\\\"\",\"value\":tru}, {\"value\":[1,,{}]} ," + messages[5] + "]";
+    expect(postStatus(body) == "200 [200,400,400,200]", "malformed message in the middle");
+    queued.clear();
+    while (Visuino::queue.pop(event)) queued.push_back(event);
+    expect(queued.size() == 2, "messages after a malformed one applied");
+    expect(postStatus("[ ]") == "200 []", "empty batch");
+    expect(postStatus(messages[3]).startsWith("200"), "single message");
+    loop();
+    return ok;
+  }
+
+  std::vector<uint32_t> takeEvents() {
+    std::vector<uint32_t> events;
+    Visuino::Event event;
+    while (Visuino::queue.pop(event)) events.push_back(static_cast<uint32_t>(event.id) << 16 ^ event.value);
+    return events;
+  }
+
+  // body padded with whitespace before its closing bracket to `size` bytes
+  String padded(const String& body, size_t size) {
+    String result = body.substring(0, body.length() - 1);
+    while (result.length() + 1 < size) result += ' ';
+    return result + "]";
+  }
+
+  // /status bodies split at every byte offset, one byte per segment and in three pieces answer and apply exactly like the
+  // body in one segment. Bodies over the budget are refused on their first segment and the budget is shared by all requests.
+  bool checkBodyReassembly() {
+    WebsiteServer::ServerInit();
+    String layout = generateLayout(40);
+    JsonReader::readWebsiteComponentsFromJson(layout);
+    loop();
+    std::vector<String> messages = inputMessages(layout, 3);
+    bool ok = true;
+    auto expect = [&ok] (bool condition, const char* what) {
+      if (!condition) fprintf(stderr, "body reassembly: %s\n", what);
+      ok &= condition;
+    };
+    const String bodies[] = {messages[0], batchBody(messages, 0, 8)};
+    for (const String& body : bodies) {
+      auto bytes = reinterpret_cast<const uint8_t*>(body.c_str());
+      size_t length = body.length();
+      String reference = postStatus(body);
+      std::vector<uint32_t> referenceEvents = takeEvents();
+      auto same = [&] (AsyncWebServerRequest& request) {
+        return replyOf(request) == reference && takeEvents() == referenceEvents && WebsiteServer::BodyBuffer::reserved == length;
+      };
+      bool splitsMatch = true;
+      for (size_t cut = 1; cut < length; cut++) {
+        AsyncWebServerRequest request(HTTP_POST, "/status");
+        server.handleBody(request, bytes, cut, 0, length);
+        server.handleBody(request, bytes + cut, length - cut, cut, length);
+        server.handle(request);
+        splitsMatch &= same(request);
+      }
+      {
+        AsyncWebServerRequest bytewise(HTTP_POST, "/status");
+        server.handle(bytewise, bytes, length, 1);
+        splitsMatch &= same(bytewise);
+      }
+      for (size_t first = 1; first < length && length < 100; first++) {
+        for (size_t second = first + 1; second < length; second++) {
+          AsyncWebServerRequest request(HTTP_POST, "/status");
+          server.handleBody(request, bytes, first, 0, length);
+          server.handleBody(request, bytes + first, second - first, first, length);
+          server.handleBody(request, bytes + second, length - second, second, length);
+          server.handle(request);
+          splitsMatch &= same(request);
+        }
+      }
+      expect(splitsMatch, length < 100 ? "split message" : "split batch");
+    }
+    expect(WebsiteServer::BodyBuffer::reserved == 0, "budget not given back");
+
+    String oversized = padded(batchBody(messages, 0, 2), BODY_BUFFER_BUDGET + 1);
+    AsyncWebServerRequest refused(HTTP_POST, "/status");
+    server.handle(refused, reinterpret_cast<const uint8_t*>(oversized.c_str()), oversized.length(), 1436);
+    expect(replyOf(refused) == "413 " && takeEvents().empty(), "oversized body");
+
+    String large = padded(batchBody(messages, 0, 4), BODY_BUFFER_BUDGET * 3 / 4);
+    String small = padded(batchBody(messages, 4, 4), BODY_BUFFER_BUDGET / 2);
+    auto first = [] (AsyncWebServerRequest& request, const String& body) {
+      server.handleBody(request, reinterpret_cast<const uint8_t*>(body.c_str()), 100, 0, body.length());
+    };
+    {
+      AsyncWebServerRequest abandoned(HTTP_POST, "/status");    // the client goes away in the middle of its body
+      first(abandoned, large);
+    }
+    expect(WebsiteServer::BodyBuffer::reserved == 0, "abandoned body kept its budget");
+    AsyncWebServerRequest a(HTTP_POST, "/status");
+    first(a, large);
+    AsyncWebServerRequest b(HTTP_POST, "/status");
+    first(b, small);
+    expect(replyOf(b) == "413 ", "budget shared by concurrent bodies");
+    server.handleBody(a, reinterpret_cast<const uint8_t*>(large.c_str()) + 100, large.length() - 100, 100, large.length());
+    server.handle(a);
+    expect(replyOf(a) == "200 [200,200,200,200]" && takeEvents().size() == 4, "body completed after a refusal");
+    loop();
+    return ok;
+  }
+
+  // value of the /metrics sample `series`, the name with its labels as exposed, -1 when missing
+  double metric(const String& text, const String& series) {
+    int at = text.indexOf(String("\n") + series + " ");
+    if (at < 0) return -1;
+    return text.substring(at + series.length() + 2).toFloat();
+  }
+
+  // Every sample line well formed, buckets cumulative up to _count, and the counts match the requests, busy answers,
+  // loop() ticks and Visuino events this run caused. Updating a counter allocates nothing, counts from 4 threads add up.
+  bool checkMetrics() {
+    WebsiteServer::ServerInit();
+    String layout = generateLayout(40);
+    JsonReader::readWebsiteComponentsFromJson(layout);
+    std::vector<String> messages = inputMessages(layout, 5);
+    bool ok = true;
+    auto expect = [&ok] (bool condition, const char* what) {
+      if (!condition) fprintf(stderr, "metrics: %s\n", what);
+      ok &= condition;
+    };
+    for (int i = 0; i < 3; i++) {
+      AsyncWebServerRequest request(HTTP_GET, "/input");
+      server.handle(request);
+      discard(request.response());
+    }
+    for (int i = 0; i < 5; i++) postStatus(messages[i]);
+    {
+      CommonJsonMemory::Guard held(Website::Card::getOutputJsonMemory());
+      expect(postStatus(messages[0]) == "204 ", "busy /status");
+    }
+    AsyncWebServerRequest asset(HTTP_GET, "/index.js");
+    server.handle(asset);
+    Serial.resetCounters();
+    for (int i = 0; i < 4; i++) loop();
+
+    AsyncWebServerRequest scrape(HTTP_GET, "/metrics");
+    server.handle(scrape);
+    String text = String("\n") + scrape.response()->drain();
+    bool wellFormed = scrape.response()->contentType().startsWith("text/plain");
+    for (int start = 1, end; start < static_cast<int>(text.length()); start = end + 1) {
+      end = text.indexOf('\n', start);
+      if (end < 0) end = text.length();
+      String line = text.substring(start, end);
+      if (line.startsWith("# TYPE ")) continue;
+      int space = line.indexOf(' ');
+      int brace = line.indexOf('{');
+      wellFormed &= space > 0 && (brace < 0 || (brace < space && line.charAt(space - 1) == '}'));
+      wellFormed &= line.substring(space + 1).length() > 0 && line.indexOf(' ', space + 1) < 0;
+    }
+    expect(wellFormed, "sample lines");
+    const char* histogram = "visuino_http_request_duration_seconds";
+    const struct {
+      const char* route;
+      double count;
+      double busy;
+    } routes[] = {{"/input", 3, 0}, {"/status", 6, 1}, {"assets", 1, 0}};
+    for (const auto& route : routes) {
+      String labels = String("route=\"") + route.route + "\"";
+      double previous = 0;
+      bool cumulative = true;
+      for (const auto& bucket : Metrics::Buckets) {
+        double value = metric(text, String(histogram) + "_bucket{" + labels + ",le=\"" + bucket.le + "\"}");
+        cumulative &= value >= previous;
+        previous = value;
+      }
+      double count = metric(text, String(histogram) + "_count{" + labels + "}");
+      cumulative &= metric(text, String(histogram) + "_bucket{" + labels + ",le=\"+Inf\"}") == count && count >= previous;
+      expect(cumulative && count == route.count, route.route);
+      expect(metric(text, String("visuino_http_busy_responses_total{") + labels + "}") == route.busy, "busy answers");
+    }
+    expect(metric(text, "visuino_loop_duration_seconds_count") == 4, "loop ticks");
+    expect(metric(text, "visuino_events_emitted_total") == 5 && Serial.linesWritten() >= 5, "events emitted");
+    expect(metric(text, "visuino_heap_free_bytes") > 0 && metric(text, "visuino_heap_largest_free_block_bytes") > 0, "heap");
+
+    uint32_t allocations = NativeHeap::allocations();
+    for (uint32_t i = 0; i < 1000; i++) {
+      Metrics::RequestTimer timer(Metrics::Route::ASSETS);
+      Metrics::markBusy(Metrics::Route::ASSETS);
+      Metrics::countEvent();
+      Metrics::recordLoop(i * 97);
+    }
+    expect(NativeHeap::allocations() == allocations, "allocation while counting");
+
+    Metrics::Histogram shared;
+    std::vector<std::thread> threads;
+    for (uint32_t t = 0; t < 4; t++) {
+      threads.emplace_back([&shared, t] {
+        for (uint32_t i = 0; i < 100000; i++) shared.record((i * 7 + t) % 200000);
+      });
+    }
+    for (std::thread& thread : threads) thread.join();
+    StreamString exposed;
+    shared.print(exposed, "shared", "");
+    uint64_t expectedUs = 0;
+    for (uint32_t t = 0; t < 4; t++) {
+      for (uint32_t i = 0; i < 100000; i++) expectedUs += (i * 7 + t) % 200000;
+    }
+    expect(metric(String("\n") + exposed, "shared_count") == 400000, "concurrent updates lost");
+    double sumS = expectedUs / 1e6;                                // metric() parses a float, compared to its precision
+    expect(std::fabs(metric(String("\n") + exposed, "shared_sum") - sumS) <= sumS * 1e-6, "concurrent sum lost");
+
+    // 2000 slow answers of 2.5 s add up to more than 32 bits of microseconds
+    Metrics::Histogram slow;
+    for (uint32_t i = 0; i < 2000; i++) slow.record(2500000);
+    StreamString slowText;
+    slow.print(slowText, "slow", "");
+    expect(metric(String("\n") + slowText, "slow_sum") == 5000, "sum wrapped");
+    return ok;
+  }
+
+  struct MetricsResult {
+    double recordNs;                      // one RequestTimer: two micros() calls and the histogram update
+    double scrapeUs;
+    size_t scrapeBytes;
+  };
+
+  MetricsResult measureMetrics(uint32_t iterations) {
+    MetricsResult result = {0, 0, 0};
+    WebsiteServer::ServerInit();
+    double start = nowUs();
+    for (uint32_t i = 0; i < iterations; i++) Metrics::RequestTimer timer(Metrics::Route::ASSETS);
+    result.recordNs = (nowUs() - start) * 1000 / iterations;
+    start = nowUs();
+    for (uint32_t i = 0; i < 100; i++) {
+      AsyncWebServerRequest request(HTTP_GET, "/metrics");
+      server.handle(request);
+      result.scrapeBytes = discard(request.response());
+    }
+    result.scrapeUs = (nowUs() - start) / 100;
+    return result;
+  }
+
+  // sum of the " xN" repeat counts of log lines mentioning `message`, 1 for a line without one
+  uint32_t loggedOccurrences(const String& text, const char* message, uint32_t& lines) {
+    uint32_t occurrences = 0;
+    lines = 0;
+    for (int at = text.indexOf(message); at >= 0; at = text.indexOf(message, at + 1)) {
+      int end = text.indexOf('\n', at);
+      String line = text.substring(at, end < 0 ? text.length() : end);
+      int repeats = line.indexOf(" x");
+      occurrences += repeats >= 0 ? static_cast<uint32_t>(line.substring(repeats + 2).toInt()) : 1;
+      lines++;
+    }
+    return occurrences;
+  }
+
+  // On the manual clock: repeats fold into one record, a message keeps sending starts a line at most once a second,
+  // the serial output stays within its byte budget, logging allocates nothing and /log lists the ring
+  bool checkLog() {
+    WebsiteServer::ServerInit();
+    NativeClock::setManual(true);
+    StreamString earlier;                                         // what this process logged before goes out first
+    for (int second = 0; second < 120; second++) {
+      NativeClock::advance(1000000);
+      Log::drain(earlier);
+    }
+    bool ok = true;
+    auto expect = [&ok] (bool condition, const char* what) {
+      if (!condition) fprintf(stderr, "log: %s\n", what);
+      ok &= condition;
+    };
+    uint32_t allocations = NativeHeap::allocations();
+    for (int i = 0; i < 1300; i++) Log::error("JSON Parse Error");
+    expect(NativeHeap::allocations() == allocations, "logging allocated");
+    StreamString ring;
+    Log::print(ring);
+    uint32_t lines;
+    expect(loggedOccurrences(ring, "JSON Parse Error", lines) == 1300 && lines == 1 && ring.indexOf("free heap ") > 0, "repeats folded");
+
+    StreamString serial;
+    for (uint32_t ms = 0; ms < 5000; ms++) {
+      Log::error("Output memory busy");
+      if (ms % 7 == 0) Log::info("Proccessing info request");
+      Log::drain(serial);
+      NativeClock::advance(1000);
+    }
+    // what 5 s earned, plus the line the budget starts with
+    expect(serial.length() <= 5 * SERIAL_LOG_BYTES_PER_SECOND + Log::MaxLineLength, "serial budget");
+    expect(loggedOccurrences(serial, "JSON Parse Error", lines) == 1300 && lines == 1, "waiting record drained");
+    loggedOccurrences(serial, "Output memory busy", lines);
+    expect(lines >= 1 && lines <= 6, "rate limited");
+    // occurrences held back by the rate limit are counted into the message's next record
+    NativeClock::advance(2000000);
+    Log::error("Output memory busy");
+    for (int second = 0; second < 60; second++) {
+      NativeClock::advance(1000000);
+      Log::drain(serial);
+    }
+    expect(loggedOccurrences(serial, "Output memory busy", lines) == 5001, "occurrences lost");
+
+    AsyncWebServerRequest request(HTTP_GET, "/log");
+    server.handle(request);
+    String body = request.response()->drain();
+    expect(request.response()->code() == 200 && body.indexOf("Output memory busy") > 0 && body.endsWith("\n"), "/log");
+    NativeClock::setManual(false);
+    return ok;
+  }
+
+  struct LogLoadResult {
+    uint32_t errorsPerSecond;
+    uint64_t textBytes;                   // the old errorStream: a line and a memory report per error, all of it sent
+    uint64_t ringBytes;
+  };
+
+  // One error message repeating like in log.txt, 60 s on the manual clock, loop() draining every 10 ms
+  LogLoadResult replayErrorLog(uint32_t errorsPerSecond) {
+    LogLoadResult result = {errorsPerSecond, 0, 0};
+    NativeClock::setManual(true);
+    const char* message = "JSON Parse Error: Json Input - Invalid input";
+    String report = String(Log::ErrorHeader) + " " + message + "\r\n" + Log::MemStats + "\r\n" + Log::FreeHeapMsg +
+                    String(ESP.getFreeHeap()) + "\r\n" + Log::MaxFreeHeapBlock + String(ESP.getMaxAllocHeap()) + "\r\n\r\n";
+    StreamString serial;
+    uint32_t pending = 0;
+    for (uint32_t tick = 0; tick < 6000; tick++) {
+      pending += errorsPerSecond;
+      for (; pending >= 100; pending -= 100) {
+        Log::error(message);
+        result.textBytes += report.length();
+      }
+      Log::drain(serial);
+      NativeClock::advance(10000);
+    }
+    result.ringBytes = serial.length();
+    NativeClock::setManual(false);
+    return result;
+  }
+
+  // Lines as they reach the UART, stamped with the micros() their last byte was handed over
+  class LineTap : public Print {
+  public:
+    struct Line {
+      uint32_t at;
+      String text;
+    };
+    size_t write(uint8_t c) override {
+      if (c == '\n') {
+        lines.push_back(Line {micros(), current});
+        current.clear();
+      } else if (c != '\r') current += static_cast<char>(c);
+      return 1;
+    }
+    using Print::write;
+    std::vector<Line> lines;
+    String current;
+  };
+
+  struct SerialLinkResult {
+    const char* mode;
+    uint32_t loopMaxUs;
+    uint64_t blockedUs;
+    uint32_t controlLines, stateLines, logLines;
+    uint32_t controlMaxUs;                // /status post to its line
+    uint32_t stateMaxUs;                  // a value set over /ws to the line carrying it
+    uint32_t logMaxUs;                    // an error to its line
+    bool whole;                           // every line one whole message
+    bool latestState;                     // the drag's last value reached Visuino
+  };
+
+  // What loop() did before SerialOutput: everything waiting written straight to Serial, the log first
+  void writeAllBlocking() {
+    Log::drain(Serial);
+    Visuino::Event event;
+    while (Visuino::queue.pop(event)) JsonWriter::writeEvent(Serial, event);
+    uint32_t since;
+    while (card.takeStateInput(event, since)) JsonWriter::writeEvent(Serial, event);
+  }
+
+  // 10 s on the manual clock with a modelled 9600 baud UART and 128 B TX FIFO, a loop() tick every ms:
+  // a switch posted to /status every 50 ms, a slider dragged over /ws every 5 ms and an error every 100 ms, five messages in turn.
+  // 3 s without input follow for the link to catch up.
+  SerialLinkResult runSerialLink(bool scheduled) {
+    SerialLinkResult result = {scheduled ? "scheduled" : "blocking", 0, 0, 0, 0, 0, 0, 0, 0, true, false};
+    WebsiteServer::ServerInit();
+    String layout = generateLayout(20);
+    JsonReader::readWebsiteComponentsFromJson(layout);
+    String switchName, sliderName;
+    DynamicJsonDocument doc(layout.length() * 2);
+    deserializeJson(doc, layout);
+    for (JsonObjectConst element : doc[JsonKey::Elements].as<JsonArrayConst>()) {
+      const char* type = element[JsonKey::ComponentType];
+      if (switchName.isEmpty() && !strcmp(type, ComponentType::Input::Switch)) switchName = element[JsonKey::Name].as<const char*>();
+      if (sliderName.isEmpty() && !strcmp(type, ComponentType::Input::Slider)) sliderName = element[JsonKey::Name].as<const char*>();
+    }
+    const char* errors[] = {"JSON Parse Error", "Output memory busy", "Component not found", "Invalid value", "Websocket frame lost"};
+    AsyncWebSocketClient* client = ws.connect();
+    NativeClock::setManual(true);
+    for (int second = 0; second < 120; second++) {                // what this process logged before goes out first
+      NativeClock::advance(1000000);
+      Log::drain(Serial);
+    }
+    LineTap tap;
+    Serial.setTxFifo(128);
+    Serial.setTap(&tap);
+    Serial.resetCounters();
+
+    std::vector<uint32_t> posted;
+    uint32_t setAt[100] = {};
+    uint32_t lastValue = 0;
+    size_t seen = 0;
+    for (uint32_t tick = 0; tick < 13000; tick++) {
+      if (tick < 10000 && tick % 50 == 0) {
+        postStatus(String("{\"name\":\"") + switchName + "\",\"componentType\":\"switch\",\"value\":" + (tick / 50 % 2 ? "true" : "false") + "}");
+        posted.push_back(micros());
+      }
+      if (tick < 10000 && tick % 5 == 0) {
+        lastValue = tick / 5 % 100;
+        String body = String("{\"name\":\"") + sliderName + "\",\"componentType\":\"slider\",\"value\":" + String(lastValue) + "}";
+        ws.receive(client, reinterpret_cast<const uint8_t*>(body.c_str()), body.length());
+        setAt[lastValue] = micros();
+      }
+      if (tick < 10000 && tick % 100 == 0) Log::error(errors[tick / 100 % 5]);
+      uint32_t start = micros();
+      if (scheduled) loop();
+      else writeAllBlocking();
+      result.loopMaxUs = std::max<uint32_t>(result.loopMaxUs, micros() - start);
+      for (; seen < tap.lines.size(); seen++) {
+        const LineTap::Line& line = tap.lines[seen];
+        if (line.text.indexOf(Log::ErrorHeader) > 0) {
+          uint32_t loggedAt = static_cast<uint32_t>(line.text.toInt() * 1000000 + line.text.substring(line.text.indexOf('.') + 1).toInt() * 1000);
+          result.logMaxUs = std::max<uint32_t>(result.logMaxUs, line.at - loggedAt);
+          result.logLines++;
+          continue;
+        }
+        StaticJsonDocument<256> event;
+        bool parsed = !deserializeJson(event, line.text);
+        const char* name = event[JsonKey::Name];
+        if (parsed && name != nullptr && switchName == name && result.controlLines < posted.size()) {
+          result.controlMaxUs = std::max<uint32_t>(result.controlMaxUs, line.at - posted[result.controlLines++]);
+        } else if (parsed && name != nullptr && sliderName == name) {
+          uint32_t value = event[JsonKey::Value];
+          result.stateMaxUs = std::max<uint32_t>(result.stateMaxUs, line.at - setAt[value % 100]);
+          result.latestState = value == lastValue;
+          result.stateLines++;
+        } else {
+          result.whole = false;
+        }
+      }
+      NativeClock::advance(1000);
+    }
+    result.blockedUs = Serial.blockedMicros();
+    result.whole &= result.controlLines == posted.size() && tap.current.isEmpty();
+    Serial.setTap(nullptr);
+    Serial.setTxFifo(0);
+    NativeClock::setManual(false);
+    return result;
+  }
+
+  // loop() never waits for the UART, a control event waits for at most one message ahead of it, nothing is cut or lost
+  // and /metrics has the delay per lane
+  bool checkSerialOutput() {
+    bool ok = true;
+    auto expect = [&ok] (bool condition, const char* what) {
+      if (!condition) fprintf(stderr, "serial output: %s\n", what);
+      ok &= condition;
+    };
+    SerialLinkResult r = runSerialLink(true);
+    expect(r.blockedUs == 0, "loop() blocked");
+    expect(r.whole, "messages cut or lost");
+    // the longest message ahead, a log line, and its own line at 960 B/s
+    expect(r.controlMaxUs <= (Log::MaxLineLength + 64) * 10000000ull / VISUINO_BAUD_RATE, "control delay");
+    expect(r.latestState && r.logLines > 0, "state or log lost");
+
+    AsyncWebServerRequest scrape(HTTP_GET, "/metrics");
+    server.handle(scrape);
+    String text = String("\n") + scrape.response()->drain();
+    const char* histogram = "visuino_serial_queue_delay_seconds";
+    expect(metric(text, String(histogram) + "_count{lane=\"control\"}") == r.controlLines &&
+           metric(text, String(histogram) + "_bucket{lane=\"control\",le=\"0.25\"}") == r.controlLines, "control histogram");
+    expect(metric(text, String(histogram) + "_count{lane=\"state\"}") == r.stateLines, "state histogram");
+    expect(metric(text, "visuino_serial_bytes_total{lane=\"log\"}") > 0, "log bytes");
+    return ok;
+  }
+
+  struct StatusBatchResult {
+    size_t batch;                         // 0: one message per POST without the array
+    uint32_t updates;
+    size_t bodyBytesPerUpdate;
+    double serverUs;                      // per POST
+  };
+
+  // Control updates posted to /status `batch` at a time, forwarded by a loop() tick after every POST
+  StatusBatchResult runStatusBatches(size_t batch, uint16_t iterations) {
+    StatusBatchResult result = {batch, 0, 0, 0};
+    WebsiteServer::ServerInit();
+    String layout = generateLayout(100);
+    JsonReader::readWebsiteComponentsFromJson(layout);
+    loop();
+    size_t perPost = std::max<size_t>(batch, 1);
+    size_t bodyBytes = 0;
+    for (uint16_t i = 0; i < iterations; i++) {
+      std::vector<String> messages = inputMessages(layout, i);
+      String body = batch == 0 ? messages[i % messages.size()] : batchBody(messages, i * perPost, perPost);
+      AsyncWebServerRequest request(HTTP_POST, "/status");
+      double start = nowUs();
+      server.handle(request, reinterpret_cast<const uint8_t*>(body.c_str()), body.length());
+      result.serverUs += nowUs() - start;
+      if (request.response() == nullptr || request.response()->code() != 200) _exit(1);
+      bodyBytes += body.length();
+      result.updates += perPost;
+      loop();
+    }
+    result.serverUs /= iterations;
+    result.bodyBytesPerUpdate = bodyBytes / result.updates;
+    return result;
+  }
+
+  class ByteSink : public Print {
+  public:
+    size_t write(uint8_t c) override {
+      bytes.push_back(c);
+      return 1;
+    }
+    size_t write(const uint8_t* data, size_t len) override {
+      bytes.insert(bytes.end(), data, data + len);
+      return len;
+    }
+    using Print::write;
+    std::vector<uint8_t> bytes;
+  };
+
+  bool sameEvent(const Visuino::Event& a, const Visuino::Event& b) {
+    return a.id == b.id && a.type == b.type && a.value == b.value;
+  }
+
+  // Frames survive the decoder stand-in, a corrupted frame and line noise (with sync bytes in it) cost only that frame
+  bool checkVisuinoFraming() {
+    using Visuino::TypeTag;
+    const Visuino::Event sent[] = {
+      {0, TypeTag::SWITCH, 1}, {1, TypeTag::SLIDER, 0xA5A5A5A5u}, {0x1A5, TypeTag::NUMBER_INPUT, Visuino::packFloat(-12.5f)},
+      {0xFFFF, TypeTag::BUTTON, 0}, {7, TypeTag::SLIDER, 42}, {8, TypeTag::SWITCH, 0},
+    };
+    const size_t corrupted = 4;
+    ByteSink wire;
+    const uint8_t noise[] = {0xA5, 0x00, 0xA5, 0x02, 0x13};
+    for (size_t i = 0; i < sizeof(sent) / sizeof(sent[0]); i++) {
+      if (i == 2) wire.write(noise, sizeof(noise));
+      size_t start = wire.bytes.size();
+      uint8_t frame[Visuino::MaxFrameSize];
+      wire.write(frame, Visuino::encodeFrame(sent[i], frame));
+      if (i == corrupted) wire.bytes[start + 4] ^= 0x10;
+    }
+    VisuinoFrameDecoder decoder;
+    std::vector<Visuino::Event> received;
+    Visuino::Event event;
+    for (uint8_t byte : wire.bytes) {
+      decoder.feed(byte);
+      while (decoder.poll(event)) received.push_back(event);
+    }
+    size_t expected = 0;
+    bool ok = received.size() == sizeof(sent) / sizeof(sent[0]) - 1 && decoder.crcErrors > 0;
+    for (size_t i = 0; ok && i < received.size(); i++, expected++) {
+      if (expected == corrupted) expected++;
+      ok = sameEvent(received[i], sent[expected]);
+    }
+    if (!ok) fprintf(stderr, "visuino framing: decoded %zu frames, %u crc errors\n", received.size(), decoder.crcErrors);
+    return ok;
+  }
+
+  struct WalkResult {
+    size_t components;
+    double walkNs;                        // per component: Card::forEachChangedOutput() over the whole layout
+    double jsonNs;                        // per component: toWebsiteJson() + measureJson()
+  };
+
+  // Full walks over the loaded layout in layout order, as done by /events and /input
+  WalkResult walkComponents(size_t count, uint16_t iterations) {
+    WalkResult result = {count, 0, 0};
+    WebsiteServer::ServerInit();
+    JsonReader::readWebsiteComponentsFromJson(generateLayout(count));
+    uint32_t since = card.getVersion();
+    volatile size_t sink = 0;
+    double perComponent = 1000.0 / (static_cast<double>(iterations) * count);
+
+    double start = nowUs();
+    for (uint16_t i = 0; i < iterations; i++) {
+      size_t changed = 0;
+      card.forEachChangedOutput(since - 1, [&changed] (Website::OutputComponent*) {changed++; return true;});
+      sink = changed;
+    }
+    result.walkNs = (nowUs() - start) * perComponent;
+
+    start = nowUs();
+    for (uint16_t i = 0; i < iterations; i++) {
+      size_t bytes = 0;
+      Website::WebsiteComponent* component;
+      for (uint16_t id = 0; (component = card.getComponentById(id)) != nullptr; id++) bytes += measureJson(component->toWebsiteJson());
+      sink = bytes;
+    }
+    result.jsonNs = (nowUs() - start) * perComponent;
+    (void)sink;
+    return result;
+  }
+
+  // Distinct pooled strings against the intern() calls answered from the pool, and the arena the layout needed
+  void printStringPool(size_t count) {
+    WebsiteServer::ServerInit();
+    JsonReader::readWebsiteComponentsFromJson(generateLayout(count));
+    const Website::StringPool& strings = card.getStrings();
+    printf("%10zu %12zu %12u %14zu %14zu\n", count, strings.size(), strings.sharedCount(), card.getArena().used(), card.getArena().size());
+  }
+
+  struct HeapLayoutResult {
+    size_t components;
+    uint32_t allocations;                 // heap allocations made while loading the layout
+    size_t loadedFree;
+    size_t loadedLargest;
+    uint8_t loadedFragmentation;
+    size_t clearedFree;                   // after Card::garbageCollect()
+    size_t clearedLargest;
+    uint8_t clearedFragmentation;
+  };
+
+  // Heap state on a device sized heap after a layout load and after the card is cleared again.
+  // The layout string is handed to the card, as setup() does with testWebsiteConfigStr.
+  HeapLayoutResult heapAfterLayout(const String& source, size_t heapSize) {
+    HeapLayoutResult result = {};
+    if (!NativeHeap::setCapacity(heapSize)) fprintf(stderr, "heap layout: cannot resize heap to %zu\n", heapSize);
+    WebsiteServer::ServerInit();
+    {
+      String layout = source;
+      uint32_t before = NativeHeap::allocations();
+      JsonReader::loadLayout(std::move(layout));
+      result.allocations = NativeHeap::allocations() - before;
+    }
+    while (card.getComponentById(static_cast<uint16_t>(result.components)) != nullptr) result.components++;
+    result.loadedFree = NativeHeap::freeBytes();
+    result.loadedLargest = NativeHeap::largestFreeBlock();
+    result.loadedFragmentation = NativeHeap::fragmentation();
+    card.garbageCollect();
+    result.clearedFree = NativeHeap::freeBytes();
+    result.clearedLargest = NativeHeap::largestFreeBlock();
+    result.clearedFragmentation = NativeHeap::fragmentation();
+    return result;
+  }
+
+  struct LinkResult {
+    const char* type;
+    size_t jsonBytes;
+    size_t binaryBytes;
+    double encodeJsonUs;
+    double encodeBinaryUs;
+  };
+
+  // Bytes per event on the Visuino link for every input type of the sample layout, JSON lines against binary frames
+  std::vector<LinkResult> runVisuinoLink(uint16_t iterations) {
+    std::vector<LinkResult> results;
+    WebsiteServer::ServerInit();
+    JsonReader::readWebsiteComponentsFromJson(generateLayout(28));
+    const char* types[] = {ComponentType::Input::Switch, ComponentType::Input::Slider, ComponentType::Input::NumberInput, ComponentType::Input::Button};
+    DynamicJsonDocument doc(testWebsiteConfigStr.length() * 4);
+    deserializeJson(doc, generateLayout(28));
+    for (const char* type : types) {
+      for (JsonObjectConst element : doc[JsonKey::Elements].as<JsonArrayConst>()) {
+        const char* elementType = element[JsonKey::ComponentType];
+        if (elementType == nullptr || strcmp(elementType, type)) continue;
+        Website::WebsiteComponent* component = nullptr;
+        for (uint16_t id = 0; (component = card.getComponentById(id)) != nullptr; id++) {
+          if (!strcmp(component->getName(), element[JsonKey::Name].as<const char*>())) break;
+        }
+        if (component == nullptr || component->asInput() == nullptr) break;
+        Visuino::Event event = component->asInput()->toVisuinoEvent();
+        LinkResult result = {type, 0, 0, 0, 0};
+        const Visuino::LinkFormat formats[] = {Visuino::LinkFormat::JSON, Visuino::LinkFormat::BINARY};
+        for (Visuino::LinkFormat format : formats) {
+          Visuino::setLinkFormat(format);
+          ByteSink sink;
+          double start = nowUs();
+          for (uint16_t i = 0; i < iterations; i++) JsonWriter::writeEvent(sink, event);
+          double us = (nowUs() - start) / iterations;
+          size_t bytes = sink.bytes.size() / iterations;
+          if (format == Visuino::LinkFormat::JSON) {
+            result.jsonBytes = bytes;
+            result.encodeJsonUs = us;
+          } else {
+            result.binaryBytes = bytes;
+            result.encodeBinaryUs = us;
+          }
+        }
+        Visuino::setLinkFormat(Visuino::LinkFormat::JSON);
+        results.push_back(result);
+        break;
+      }
+    }
+    return results;
+  }
+
+  struct QueueStressResult {
+    uint32_t producers;
+    uint32_t events;
+    uint32_t enqueued;
+    uint32_t coalesced;
+    uint32_t dropped;
+    uint32_t delivered;
+    uint32_t outOfOrder;
+    uint32_t wrongFinal;
+    double eventsPerSecond;
+  };
+
+  // Producers hammer one EventQueue from several threads while a consumer thread plays loop().
+  // Every component belongs to one producer and gets increasing values, so the consumer can check ordering
+  // and that the last value of every component arrives.
+  QueueStressResult stressVisuinoQueue(uint32_t producers, uint32_t perProducer, uint32_t pace) {
+    const uint32_t componentsPerProducer = 8;
+    const uint32_t componentCount = producers * componentsPerProducer;
+    std::unique_ptr<Visuino::EventQueue> queue(new Visuino::EventQueue());
+    std::unique_ptr<Visuino::OverflowSlot[]> slots(new Visuino::OverflowSlot[componentCount]);
+    std::vector<uint32_t> lastDelivered(componentCount, 0);
+    QueueStressResult result = {};
+    result.producers = producers;
+    result.events = producers * perProducer;
+
+    auto deliver = [&] (uint16_t id, uint32_t value) {
+      if (value < lastDelivered[id]) result.outOfOrder++;
+      lastDelivered[id] = value;
+      result.delivered++;
+    };
+    auto drain = [&] {
+      Visuino::Event event;
+      while (queue->pop(event)) deliver(event.id, event.value);
+      if (queue->takeOverflow()) {
+        for (uint16_t id = 0; id < componentCount; id++) {
+          uint32_t value;
+          if (queue->takeParked(slots[id], value)) deliver(id, value);
+        }
+      }
+    };
+
+    std::atomic<bool> done(false);
+    std::atomic<uint32_t> ready(0);
+    std::thread consumer([&] {
+      ready.fetch_add(1);
+      while (!done.load(std::memory_order_acquire)) drain();
+      drain();
+    });
+    std::vector<std::thread> threads;
+    for (uint32_t p = 0; p < producers; p++) {
+      threads.emplace_back([&, p] {
+        ready.fetch_add(1);
+        while (ready.load() < producers + 1) {}
+        for (uint32_t i = 0; i < perProducer; i++) {
+          uint16_t id = static_cast<uint16_t>(p * componentsPerProducer + i % componentsPerProducer);
+          queue->push(Visuino::Event {id, Visuino::TypeTag::SLIDER, i + 1}, &slots[id]);
+          // a little work between events, otherwise the producers fill the ring before the consumer is scheduled at all
+          for (volatile uint32_t k = 0; k < pace; k++) {}
+        }
+      });
+    }
+    while (ready.load() < producers + 1) {}
+    double start = nowUs();
+    for (auto& thread : threads) thread.join();
+    done.store(true, std::memory_order_release);
+    consumer.join();
+    result.eventsPerSecond = result.events / ((nowUs() - start) / 1e6);
+
+    result.enqueued = queue->enqueuedCount();
+    result.coalesced = queue->coalescedCount();
+    result.dropped = queue->droppedCount();
+    for (uint16_t id = 0; id < componentCount; id++) {
+      uint32_t last = perProducer - componentsPerProducer + id % componentsPerProducer + 1;
+      if (lastDelivered[id] != last) result.wrongFinal++;
+    }
+    return result;
+  }
+
+  bool checkQueueStress(const QueueStressResult& r) {
+    return r.enqueued + r.coalesced + r.dropped == r.events && r.dropped == 0 && r.outOfOrder == 0 && r.wrongFinal == 0;
+  }
+
+  struct MemoryContentionResult {
+    uint32_t threads;
+    uint32_t attempts;
+    uint32_t owned;
+    uint32_t overlaps;                    // a second owner seen inside a guard, must stay 0
+    CommonJsonMemory::Stats stats;
+    double guardNs;                       // acquire + release, per attempt
+  };
+
+  // Several threads take the same CommonJsonMemory with Guards, as the AsyncTCP task and loop() do on the ESP32
+  MemoryContentionResult contendJsonMemory(uint32_t threads, uint32_t perThread, uint32_t timeoutMs) {
+    MemoryContentionResult result = {threads, threads * perThread, 0, 0, {0, 0, 0}, 0};
+    CommonJsonMemory memory;
+    memory.allocate(64);
+    std::atomic<uint32_t> owners(0), owned(0), overlaps(0), ready(0);
+    std::vector<std::thread> workers;
+    for (uint32_t t = 0; t < threads; t++) {
+      workers.emplace_back([&] {
+        ready.fetch_add(1);
+        while (ready.load() < threads) {}
+        for (uint32_t i = 0; i < perThread; i++) {
+          CommonJsonMemory::Guard guard(&memory, timeoutMs);
+          if (!guard) continue;
+          if (owners.fetch_add(1) != 0) overlaps.fetch_add(1);
+          for (volatile uint32_t k = 0; k < 20; k++) {}
+          owners.fetch_sub(1);
+          owned.fetch_add(1, std::memory_order_relaxed);
+        }
+      });
+    }
+    double start = nowUs();
+    for (auto& worker : workers) worker.join();
+    result.guardNs = (nowUs() - start) * 1000.0 / result.attempts;
+    result.owned = owned.load();
+    result.overlaps = overlaps.load();
+    result.stats = memory.getStats();
+    return result;
+  }
+
+  bool checkMemoryContention(const MemoryContentionResult& r) {
+    bool ok = r.overlaps == 0 && r.stats.acquisitions == r.owned && r.stats.acquisitions + r.stats.failures == r.attempts;
+    if (!ok) fprintf(stderr, "json memory: %u overlaps, %u acquisitions for %u owned\n", r.overlaps, r.stats.acquisitions, r.owned);
+    return ok;
+  }
+
+  // Name lookups as done by /status on a loaded card, against the linear strcmp scan the pool replaced, and name equality
+  // by strcmp against the pooled handle compare. Every component must be found by its handle, and equal handles mean equal names.
+  bool lookupComparison(size_t count, uint32_t lookups) {
+    WebsiteServer::ServerInit();
+    JsonReader::readWebsiteComponentsFromJson(generateLayout(count));
+    std::vector<Website::WebsiteComponent*> components;
+    for (uint16_t id = 0; card.getComponentById(id) != nullptr; id++) components.push_back(card.getComponentById(id));
+    size_t size = components.size();
+    bool ok = size == count;
+    for (size_t i = 0; ok && i < size; i++) {
+      for (size_t j = i; ok && j < std::min(size, i + 8); j++) {
+        bool sameName = !strcmp(components[i]->getName(), components[j]->getName());
+        ok = sameName == (components[i]->getNameHandle() == components[j]->getNameHandle());
+      }
+      ok = ok && card.getComponentByHandle(components[i]->getNameHandle()) == components[i];
+    }
+    if (!ok) {
+      fprintf(stderr, "name handles: %zu components, lookup by handle or handle equality broken\n", size);
+      return false;
+    }
+    // names as a /status message brings them, outside the pool
+    std::vector<String> names;
+    names.reserve(size);
+    for (Website::WebsiteComponent* component : components) names.push_back(component->getName());
+
+    volatile intptr_t sink = 0;
+    double start = nowUs();
+    for (uint32_t i = 0; i < lookups; i++) {
+      const char* name = names[(i * 7919u) % size].c_str();
+      for (Website::WebsiteComponent* component : components) {
+        if (!strcmp(component->getName(), name)) {
+          sink = reinterpret_cast<intptr_t>(component);
+          break;
+        }
+      }
+    }
+    double linearNs = (nowUs() - start) * 1000.0 / lookups;
+
+    start = nowUs();
+    for (uint32_t i = 0; i < lookups; i++) {
+      sink = reinterpret_cast<intptr_t>(card.getComponentByName(names[(i * 7919u) % size].c_str()));
+    }
+    double indexNs = (nowUs() - start) * 1000.0 / lookups;
+
+    // pairs with a common prefix, the usual case in a layout ("slider_12" against "slider_17")
+    start = nowUs();
+    for (uint32_t i = 0; i < lookups; i++) {
+      sink += !strcmp(components[(i * 7919u) % size]->getName(), components[(i * 104729u) % size]->getName());
+    }
+    double strcmpNs = (nowUs() - start) * 1000.0 / lookups;
+
+    start = nowUs();
+    for (uint32_t i = 0; i < lookups; i++) {
+      sink += components[(i * 7919u) % size]->getNameHandle() == components[(i * 104729u) % size]->getNameHandle();
+    }
+    double handleNs = (nowUs() - start) * 1000.0 / lookups;
+    (void)sink;
+    printf("%10zu %12.1f %12.1f %12.2f %12.2f\n", size, linearNs, indexNs, strcmpNs, handleNs);
+    return true;
+  }
+
+  // ComponentIndex must hold MaxComponents names in one reserve() and find each of them
+  bool checkIndexCapacity() {
+    const size_t count = Website::ComponentIndex::MaxComponents;
+    std::vector<String> names;
+    names.reserve(count);
+    for (size_t i = 0; i < count; i++) names.push_back(String("c") + String(static_cast<unsigned long>(i)));
+    Website::ComponentIndex index;
+    if (!index.reserve(count)) {
+      fprintf(stderr, "component index: reserve(%zu) refused\n", count);
+      return false;
+    }
+    for (size_t i = 0; i < count; i++) index.insert(names[i].c_str(), static_cast<uint16_t>(i));
+    for (size_t i = 0; i < count; i++) {
+      if (index.find(names[i].c_str(), [&names] (uint16_t slot) {return names[slot].c_str();}) != static_cast<int32_t>(i)) {
+        fprintf(stderr, "component index: %s not found\n", names[i].c_str());
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // componentType dispatch must accept exact names only, prefixes and unknown types are rejected
+  bool checkTypeDispatch() {
+    struct Case {const char* json; Website::Card::ComponentStatus expected;};
+    const Case cases[] = {
+      {"{\"name\":\"a\",\"componentType\":\"switch\"}", Website::Card::ComponentStatus::OK},
+      {"{\"name\":\"b\",\"componentType\":\"progressBar\"}", Website::Card::ComponentStatus::OK},
+      {"{\"name\":\"c\",\"componentType\":\"s\"}", Website::Card::ComponentStatus::COMPONENT_TYPE_NOT_FOUND},
+      {"{\"name\":\"d\",\"componentType\":\"switches\"}", Website::Card::ComponentStatus::COMPONENT_TYPE_NOT_FOUND},
+      {"{\"name\":\"e\",\"componentType\":\"chart\"}", Website::Card::ComponentStatus::COMPONENT_TYPE_NOT_FOUND},
+      {"{\"name\":\"f\",\"componentType\":\"\"}", Website::Card::ComponentStatus::COMPONENT_TYPE_NOT_FOUND},
+      {"{\"name\":\"g\",\"componentType\":7}", Website::Card::ComponentStatus::COMPONENT_TYPE_NOT_FOUND},
+      {"{\"name\":\"h\"}", Website::Card::ComponentStatus::OBJECT_NOT_VALID},
+    };
+    Website::Card testCard;
+    bool ok = true;
+    for (const Case& c : cases) {
+      DynamicJsonDocument doc(512);
+      deserializeJson(doc, c.json);
+      if (testCard.add(doc.as<JsonObjectConst>()) != c.expected) {
+        fprintf(stderr, "type dispatch: unexpected result for %s\n", c.json);
+        ok = false;
+      }
+    }
+    return ok;
+  }
+
+  // chunked /input must produce the same valid document whatever the TCP segment size is
+  bool checkChunkedInput() {
+    WebsiteServer::ServerInit();
+    String layout = generateLayout(40);
+    JsonReader::readWebsiteComponentsFromJson(layout);
+    String reference;
+    const size_t segmentSizes[] = {1436, 1, 7, 64, 333};
+    for (size_t segmentSize : segmentSizes) {
+      AsyncWebServerRequest request(HTTP_GET, "/input");
+      server.handle(request);
+      String body = request.response() ? request.response()->drain(segmentSize) : String();
+      DynamicJsonDocument doc(body.length() * 2 + 64);
+      if (deserializeJson(doc, body) || doc[JsonKey::Elements].as<JsonArrayConst>().size() != 40) {
+        fprintf(stderr, "chunked /input: invalid document with %zu byte segments\n", segmentSize);
+        return false;
+      }
+      if (reference.isEmpty()) reference = body;
+      else if (body != reference) {
+        fprintf(stderr, "chunked /input: output differs with %zu byte segments\n", segmentSize);
+        return false;
+      }
+    }
+    // overlapping elements paint in DOM order, so /input keeps the layout's order
+    DynamicJsonDocument source(layout.length() * 2);
+    DynamicJsonDocument served(reference.length() * 2 + 64);
+    deserializeJson(source, layout);
+    deserializeJson(served, reference);
+    JsonArrayConst sourceElements = source[JsonKey::Elements].as<JsonArrayConst>();
+    JsonArrayConst servedElements = served[JsonKey::Elements].as<JsonArrayConst>();
+    for (size_t i = 0; i < sourceElements.size(); i++) {
+      if (String(sourceElements[i][JsonKey::Name].as<const char*>()) != servedElements[i][JsonKey::Name].as<const char*>()) {
+        fprintf(stderr, "chunked /input: element %zu is not in layout order\n", i);
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // Gauges with one-digit numbers and short names: short keys and values cost more slots than text, 2x the length is not enough
+  String compactLayout(size_t count) {
+    String layout = "{\"elements\":[";
+    for (size_t i = 0; i < count; i++) {
+      if (i > 0) layout += ',';
+      layout += String("{\"name\":\"g") + String(static_cast<unsigned long>(i)) +
+                "\",\"componentType\":\"gauge\",\"posX\":1,\"posY\":2,\"width\":3,\"height\":4,\"value\":5,\"minValue\":0,\"maxValue\":9}";
+    }
+    layout += "]}";
+    return layout;
+  }
+
+  // Escapes and repeated strings in one layout, the parts of the text the capacity scan has to get right
+  String escapedLayout() {
+    return String("{\"title\":\"Caf\\u00e9 \\\"panel\\\"\",\"elements\":[") +
+           "{\"name\":\"l\\u00e9\\u20ac\",\"componentType\":\"label\",\"posX\":1,\"posY\":2,\"value\":\"\\uD83D\\uDE00 \\n\\t\\\\\",\"color\":\"red\"}," +
+           "{\"name\":\"red\",\"componentType\":\"label\",\"posX\":1 , \"posY\" : 2,\"value\":\"red\",\"color\":\"red\"}," +
+           "{\"name\":\"n\",\"componentType\":\"numberInput\",\"posX\":-1,\"posY\":2e1,\"value\":-0.5,\"color\":null}]}";
+  }
+
+  // Without deduplication the scan is exact, with it the copy room for the longest string is on top, below this in every layout here
+  const size_t MaxCapacitySlack = JSON_STRING_SIZE(64);
+
+  bool checkCapacity(const char* name, const String& layout) {
+    size_t capacity = JsonReader::measureCapacity(layout.c_str(), layout.length());
+    DynamicJsonDocument doc(capacity);
+    DeserializationError error = deserializeJson(doc, layout);
+    if (error || doc.overflowed()) {
+      fprintf(stderr, "capacity: %s overflows %zu bytes\n", name, capacity);
+      return false;
+    }
+    if (capacity - doc.memoryUsage() > MaxCapacitySlack) {
+      fprintf(stderr, "capacity: %s gets %zu bytes for %zu used\n", name, capacity, doc.memoryUsage());
+      return false;
+    }
+    return true;
+  }
+
+  // The sized documents hold every layout, every component's JSON and every /status message without overflow or spare room
+  bool checkJsonCapacity() {
+    const size_t counts[] = {1, 7, 40, 300};
+    for (size_t count : counts) {
+      if (!checkCapacity("generated", generateLayout(count))) return false;
+      if (!checkCapacity("compact", compactLayout(count))) return false;
+    }
+    if (!checkCapacity("escaped", escapedLayout())) return false;
+
+    WebsiteServer::ServerInit();
+    String layout = generateLayout(40);
+    if (JsonReader::readWebsiteComponentsFromJson(layout) != JsonReader::InputJsonStatus::OK) return false;
+    size_t largest = 0;
+    Website::WebsiteComponent* component;
+    for (uint16_t id = 0; (component = card.getComponentById(id)) != nullptr; id++) {
+      CommonJsonMemory::Guard guard(Website::WebsiteComponent::getJsonMemory());
+      DynamicJsonDocument* doc = JsonReader::componentJsonMemory.get();
+      component->toWebsiteJson();
+      bool overflowed = doc->overflowed();
+      largest = std::max(largest, doc->memoryUsage());
+      if (component->asOutput() != nullptr) {
+        component->asOutput()->toStateJson();
+        overflowed |= doc->overflowed();
+      }
+      if (overflowed) {
+        fprintf(stderr, "capacity: %s overflows the component memory\n", component->getName());
+        return false;
+      }
+    }
+    if (largest != JsonReader::componentJsonMemory.get()->capacity()) {
+      fprintf(stderr, "capacity: component memory %zu, largest component %zu\n", JsonReader::componentJsonMemory.get()->capacity(), largest);
+      return false;
+    }
+    for (const String& body : statusBodies(layout)) {
+      AsyncWebServerRequest request(HTTP_POST, "/status");
+      server.handle(request, reinterpret_cast<const uint8_t*>(body.c_str()), body.length());
+      if (request.response() == nullptr || request.response()->code() != HTTP_STATUS_OK) {
+        fprintf(stderr, "capacity: /status rejected %s\n", body.c_str());
+        return false;
+      }
+    }
+    return true;
+  }
+
+  struct CapacityResult {
+    const char* layout;
+    size_t components;
+    size_t jsonBytes;
+    size_t heuristicBytes;                // json.length() * 2, the old sizing
+    size_t exactBytes;
+    size_t usedBytes;
+    bool heuristicFits;
+  };
+
+  CapacityResult compareCapacity(const char* name, const String& layout, size_t count) {
+    CapacityResult result = {name, count, layout.length(), layout.length() * 2, 0, 0, false};
+    result.exactBytes = JsonReader::measureCapacity(layout.c_str(), layout.length());
+    DynamicJsonDocument doc(result.exactBytes);
+    deserializeJson(doc, layout);
+    result.usedBytes = doc.memoryUsage();
+    DynamicJsonDocument heuristic(result.heuristicBytes);
+    result.heuristicFits = !deserializeJson(heuristic, layout) && !heuristic.overflowed();
+    return result;
+  }
+
+  // The whole /input body of a card, pulled through fillHTTPResponse() like the chunked response does
+  String cardResponse(Website::Card& from) {
+    Website::Card::ResponseCursor cursor;
+    String body;
+    uint8_t segment[97];
+    size_t written;
+    while ((written = from.fillHTTPResponse(cursor, segment, sizeof(segment))) > 0) body.concat(reinterpret_cast<char*>(segment), written);
+    return body;
+  }
+
+  // A layout parsed in place serves the same /input as one whose strings were copied, and its components point into the adopted text.
+  // An update adding a component afterwards copies that component's strings, its text is gone once the call returns.
+  bool checkInPlaceLayout(const String& layout) {
+    WebsiteServer::ServerInit();
+    Website::Card copied;
+    {
+      DynamicJsonDocument doc(JsonReader::measureCapacity(layout.c_str(), layout.length()));
+      deserializeJson(doc, layout);
+      JsonArrayConst elements = doc[JsonKey::Elements].as<JsonArrayConst>();
+      copied.reserve(elements);
+      for (JsonObjectConst element : elements) copied.add(element);
+    }
+    String text = layout;
+    if (JsonReader::loadLayout(std::move(text)) != JsonReader::InputJsonStatus::OK) return false;
+    Website::WebsiteComponent* component;
+    for (uint16_t id = 0; (component = card.getComponentById(id)) != nullptr; id++) {
+      if (!card.getStrings().isBorrowed(component->getName())) {
+        fprintf(stderr, "in place: %s was copied\n", component->getName());
+        return false;
+      }
+    }
+    if (cardResponse(card) != cardResponse(copied)) {
+      fprintf(stderr, "in place: /input differs from the copied layout\n");
+      return false;
+    }
+    {
+      String update = "{\"elements\":[{\"name\":\"late\",\"componentType\":\"switch\",\"posX\":1,\"posY\":2,\"size\":3}]}";
+      JsonReader::readWebsiteComponentsFromJson(update);
+      DynamicJsonDocument doc(256);
+      deserializeJson(doc, update);
+      copied.add(doc[JsonKey::Elements].as<JsonArrayConst>()[0].as<JsonObjectConst>());
+      memset(update.begin(), 'x', update.length());
+    }
+    if (cardResponse(card) != cardResponse(copied)) {
+      fprintf(stderr, "in place: /input differs after an update\n");
+      return false;
+    }
+    return true;
+  }
+
+  struct LoadHeapResult {
+    size_t components;
+    size_t textBytes;
+    size_t copiedPeak;                    // heap above what the caller held before the load, the layout text included
+    size_t copiedResident;                // after the caller dropped its copy of the text
+    size_t inPlacePeak;
+    size_t inPlaceResident;
+  };
+
+  // Heap of one layout load, measured from before the caller built the layout text
+  void measureLoad(const String& source, bool inPlace, size_t& peak, size_t& resident) {
+    WebsiteServer::ServerInit();
+    size_t before = NativeHeap::used();
+    NativeHeap::resetPeak();
+    {
+      String layout(source.c_str());                            // exact size, like testWebsiteConfigStr
+      if (inPlace) JsonReader::loadLayout(std::move(layout));
+      else JsonReader::readWebsiteComponentsFromJson(layout);
+    }
+    peak = NativeHeap::peak() - before;
+    resident = NativeHeap::used() - before;
+  }
+
+  // Layout text kept outside the simulated heap, read like a file in flash
+  class FlashStream : public Stream {
+  public:
+    explicit FlashStream(const String& text) : length(text.length()) {
+      data = static_cast<char*>(__real_malloc(length + 1));
+      memcpy(data, text.c_str(), length + 1);
+    }
+    ~FlashStream() {__real_free(data);}
+    FlashStream(const FlashStream&) = delete;
+    FlashStream& operator=(const FlashStream&) = delete;
+    int available() override {return static_cast<int>(length - position);}
+    int read() override {return position < length ? static_cast<unsigned char>(data[position++]) : -1;}
+    int peek() override {return position < length ? static_cast<unsigned char>(data[position]) : -1;}
+    size_t write(uint8_t) override {return 0;}
+    void rewind() {position = 0;}
+    const char* text() const {return data;}
+  private:
+    char* data;
+    size_t length;
+    size_t position = 0;
+  };
+
+  // A streamed layout ends up in the same card as `reference` parsed in a single document, the elements before a failing one stay
+  bool checkStreamedLayout(const String& layout, const String& reference, JsonReader::InputJsonStatus expected) {
+    WebsiteServer::ServerInit();
+    Website::Card copied;
+    {
+      DynamicJsonDocument doc(JsonReader::measureCapacity(reference.c_str(), reference.length()));
+      deserializeJson(doc, reference);
+      for (JsonObjectConst element : doc[JsonKey::Elements].as<JsonArrayConst>()) {
+        if (copied.add(element) != Website::Card::ComponentStatus::OK) break;
+      }
+    }
+    FlashStream stream(layout);
+    JsonReader::InputJsonStatus status = JsonReader::readWebsiteComponentsFromStream(stream, 512);
+    if (status != expected) {
+      fprintf(stderr, "streamed: %s, expected %s\n", JsonReader::errorHandler(status), JsonReader::errorHandler(expected));
+      return false;
+    }
+    if (cardResponse(card) != cardResponse(copied)) {
+      fprintf(stderr, "streamed: /input differs from the layout parsed at once\n");
+      return false;
+    }
+    return true;
+  }
+
+  bool checkStreamedLayouts() {
+    using JsonReader::InputJsonStatus;
+    String tooBig = generateLayout(12);
+    String text;
+    for (int i = 0; i < 600; i++) text += 'a';
+    tooBig = tooBig.substring(0, tooBig.length() - 2) + String(",{\"name\":\"big\",\"componentType\":\"label\",\"posX\":1,\"posY\":2,\"value\":\"") + text + "\"}]}";
+    String unknownType = generateLayout(5);
+    unknownType = unknownType.substring(0, unknownType.length() - 2) + String(",{\"name\":\"x\",\"componentType\":\"chart\"},{\"name\":\"y\",\"componentType\":\"switch\"}]}");
+    // "elements" as a value, as a nested key and inside a string before the real key, which has a space before its ':'
+    String decoys = generateLayout(10);
+    decoys = String("{\"title\":\"elements\",\"meta\":{\"elements\":[{\"name\":\"x\",\"componentType\":\"chart\"}]},") +
+             "\"note\":\"\\\"elements\\\": [\",\"elements\" " + decoys.substring(decoys.indexOf(':'));
+    const struct {
+      const char* name;
+      String layout;
+      String reference;
+      InputJsonStatus expected;
+    } cases[] = {
+      {"decoy keys", decoys, generateLayout(10), InputJsonStatus::OK},
+      {"generated", generateLayout(40), generateLayout(40), InputJsonStatus::OK},
+      {"built-in", testWebsiteConfigStr, testWebsiteConfigStr, InputJsonStatus::OK},
+      {"escaped", escapedLayout(), escapedLayout(), InputJsonStatus::OK},
+      {"too big", tooBig, generateLayout(12), InputJsonStatus::JSON_OVERFLOW},
+      {"unknown type", unknownType, generateLayout(5), InputJsonStatus::COMPONENT_TYPE_NOT_FOUND},
+    };
+    for (const auto& test : cases) {
+      if (!isolated([&] {if (!checkStreamedLayout(test.layout, test.reference, test.expected)) _exit(1);})) {
+        fprintf(stderr, "streamed: %s layout failed\n", test.name);
+        return false;
+      }
+    }
+    return true;
+  }
+
+  enum class LoadPath : uint8_t {COPIED, IN_PLACE, STREAMED};
+
+  // Whether a layout loads completely with `budget` bytes of free heap after ServerInit().
+  // The text starts in flash, the String paths need it in RAM first, as it arrives over HTTP or is read from a file.
+  bool loadsWithin(LoadPath path, FlashStream& flash, size_t count, size_t budget) {
+    return isolated([&] {
+      if (freopen("/dev/null", "w", stderr) == nullptr) _exit(2);   // running out of heap is the expected way to fail
+      WebsiteServer::ServerInit();
+      if (!NativeHeap::setCapacity(NativeHeap::used() + budget)) _exit(2);
+      JsonReader::InputJsonStatus status;
+      if (path == LoadPath::STREAMED) status = JsonReader::readWebsiteComponentsFromStream(flash);
+      else {
+        String layout(flash.text());
+        if (layout.length() == 0) _exit(1);
+        status = path == LoadPath::COPIED ? JsonReader::readWebsiteComponentsFromJson(layout) : JsonReader::loadLayout(std::move(layout));
+      }
+      if (status != JsonReader::InputJsonStatus::OK || card.getComponentById(static_cast<uint16_t>(count - 1)) == nullptr) _exit(1);
+    });
+  }
+
+  // Largest generated layout which loads within budget: doubling, then bisecting
+  size_t largestLayout(LoadPath path, size_t budget) {
+    auto loads = [path, budget] (size_t count) {
+      FlashStream flash(generateLayout(count));
+      return loadsWithin(path, flash, count, budget);
+    };
+    size_t good = 0;
+    size_t bad = 1;
+    while (loads(bad)) {
+      good = bad;
+      bad *= 2;
+    }
+    while (bad - good > 1) {
+      size_t middle = (good + bad) / 2;
+      if (loads(middle)) good = middle;
+      else bad = middle;
+    }
+    return good;
+  }
+
+  // /input elements without the version header, a card refilled after a failed snapshot continues its version
+  String cardElements(Website::Card& from) {
+    String body = cardResponse(from);
+    return body.substring(body.indexOf(JsonKey::Elements));
+  }
+
+  std::vector<uint8_t> readFile(const char* path) {
+    File file = SPIFFS.open(path);
+    std::vector<uint8_t> bytes(file.size());
+    if (!bytes.empty()) file.read(bytes.data(), bytes.size());
+    return bytes;
+  }
+
+  void writeFile(const char* path, const uint8_t* data, size_t length) {
+    File file = SPIFFS.open(path, FILE_WRITE);
+    file.write(data, length);
+  }
+
+  // One boot in its own process: bootLayout() must log `expected` and serve the same elements as the layout parsed at once
+  bool bootsAs(const String& layout, bool fromFile, const char* expected) {
+    return isolated([&] {
+      WebsiteServer::ServerInit();
+      Website::Card reference;
+      {
+        DynamicJsonDocument doc(JsonReader::measureCapacity(layout.c_str(), layout.length()));
+        deserializeJson(doc, layout);
+        JsonArrayConst elements = doc[JsonKey::Elements].as<JsonArrayConst>();
+        reference.reserve(elements);
+        for (JsonObjectConst element : elements) reference.add(element);
+      }
+      if (fromFile) writeFile(LayoutPath, reinterpret_cast<const uint8_t*>(layout.c_str()), layout.length());
+      else {
+        SPIFFS.remove(LayoutPath);
+        testWebsiteConfigStr = layout;
+      }
+      if (Snapshot::bootLayout() != JsonReader::InputJsonStatus::OK) _exit(1);
+      StreamString logged;
+      Log::print(logged);
+      if (logged.indexOf(expected) < 0) {
+        fprintf(stderr, "snapshot: expected \"%s\", log:\n%s", expected, logged.c_str());
+        _exit(1);
+      }
+      if (cardElements(card) != cardElements(reference)) {
+        fprintf(stderr, "snapshot: /input differs from the parsed layout after \"%s\"\n", expected);
+        _exit(1);
+      }
+      if (!testWebsiteConfigStr.isEmpty() || !SPIFFS.exists(SnapshotPath)) _exit(1);
+    });
+  }
+
+  // Values changed after the load are in the snapshot, which loads into a card serving the same /input
+  bool checkSnapshotValues(const String& layout) {
+    WebsiteServer::ServerInit();
+    String text = layout;
+    if (JsonReader::loadLayout(std::move(text)) != JsonReader::InputJsonStatus::OK) return false;
+    const char* changes[] = {
+      "{\"name\":\"Motor_1\",\"componentType\":\"switch\",\"value\":true}",
+      "{\"name\":\"Slidee_12\",\"componentType\":\"slider\",\"value\":77}",
+      "{\"name\":\"other temperature_14\",\"componentType\":\"numberInput\",\"value\":21.5}",
+    };
+    for (const char* change : changes) card.onComponentStatusHTTPRequest(reinterpret_cast<const uint8_t*>(change), strlen(change));
+    String before = cardElements(card);
+    uint32_t hashed = Snapshot::layoutHash(layout);
+    {
+      File file = SPIFFS.open(SnapshotPath, FILE_WRITE);
+      if (!Snapshot::save(file, hashed)) return false;
+    }
+    card.garbageCollect();
+    File file = SPIFFS.open(SnapshotPath);
+    Snapshot::Status status = Snapshot::load(file, hashed);
+    if (status != Snapshot::Status::OK) {
+      fprintf(stderr, "snapshot: %s\n", Snapshot::statusMessage(status));
+      return false;
+    }
+    if (cardElements(card) != before) {
+      fprintf(stderr, "snapshot: changed values did not survive\n");
+      return false;
+    }
+    return before.indexOf("\"value\":77") >= 0 && before.indexOf("\"value\":21.5") >= 0;
+  }
+
+  bool checkSnapshots() {
+    using namespace ErrorMessage::Snapshot;
+    char dir[] = "/tmp/visuino-snapshot-XXXXXX";
+    if (mkdtemp(dir) == nullptr) return false;
+    SPIFFS.setRoot(dir);
+    String first = generateLayout(40);
+    String second = escapedLayout();
+    String builtIn = testWebsiteConfigStr;
+    bool ok = bootsAs(first, false, Missing) && bootsAs(first, false, Loaded) && bootsAs(second, false, Stale) &&
+              bootsAs(second, false, Loaded) && bootsAs(builtIn, true, Stale) && bootsAs(builtIn, true, Loaded);
+    if (ok) {
+      std::vector<uint8_t> snapshot = readFile(SnapshotPath);
+      writeFile(SnapshotPath, snapshot.data(), snapshot.size() / 2);
+      ok = bootsAs(builtIn, true, Corrupt) && bootsAs(builtIn, true, Loaded);
+      // a flipped value is only caught by the trailer, after components were built from it
+      snapshot[snapshot.size() - 12] ^= 0x40;
+      writeFile(SnapshotPath, snapshot.data(), snapshot.size());
+      ok = ok && bootsAs(builtIn, true, Corrupt) && bootsAs(builtIn, true, Loaded);
+      // an arena size which would wrap the reservation is refused before anything is allocated
+      snapshot = readFile(SnapshotPath);
+      const size_t arenaBytesAt = 14;
+      for (size_t i = 0; i < 4; i++) snapshot[arenaBytesAt + i] = i == 0 ? 0xF0 : 0xFF;
+      writeFile(SnapshotPath, snapshot.data(), snapshot.size());
+      ok = ok && isolated([&] {
+        WebsiteServer::ServerInit();
+        File file = SPIFFS.open(SnapshotPath, "r");
+        uint32_t allocations = NativeHeap::allocations();
+        if (Snapshot::load(file, Snapshot::layoutHash(builtIn)) != Snapshot::Status::CORRUPT ||
+            NativeHeap::allocations() - allocations > 1 || !card.isEmpty()) {
+          fprintf(stderr, "snapshot: a wrapping arena size got past the header check\n");
+          _exit(1);
+        }
+      });
+      ok = ok && bootsAs(builtIn, true, Corrupt) && bootsAs(builtIn, true, Loaded);
+    }
+    ok = ok && isolated([&] {if (!checkSnapshotValues(first)) _exit(1);});
+    SPIFFS.remove(SnapshotPath);
+    SPIFFS.remove(LayoutPath);
+    rmdir(dir);
+    SPIFFS.setRoot("");
+    return ok;
+  }
+
+  struct BootResult {
+    size_t components;
+    size_t jsonBytes;
+    size_t snapshotBytes;
+    double hashUs;                        // hashing /layout.json, paid on every boot
+    double parseUs;                       // layout text in RAM, parsed in place
+    double streamUs;                      // /layout.json streamed element by element
+    double saveUs;
+    double loadUs;                        // /layout.bin
+  };
+
+  // fn returns the microseconds of the part it measures, its setup and cleanup are left out
+  template <typename Fn> double averageUs(uint16_t iterations, Fn fn) {
+    double total = 0;
+    for (uint16_t i = 0; i < iterations; i++) total += fn();
+    return total / iterations;
+  }
+
+  // Boot phases of one layout kept in SPIFFS, every load into an empty card
+  BootResult measureBoot(size_t count, uint16_t iterations) {
+    char dir[] = "/tmp/visuino-boot-XXXXXX";
+    if (mkdtemp(dir) == nullptr) _exit(1);
+    SPIFFS.setRoot(dir);
+    WebsiteServer::ServerInit();
+    String layout = generateLayout(count);
+    writeFile(LayoutPath, reinterpret_cast<const uint8_t*>(layout.c_str()), layout.length());
+    BootResult result = {count, layout.length(), 0, 0, 0, 0, 0, 0};
+    uint32_t hashed = 0;
+    result.hashUs = averageUs(iterations, [&] {
+      File file = SPIFFS.open(LayoutPath);
+      double start = nowUs();
+      hashed = Snapshot::layoutHash(file);
+      return nowUs() - start;
+    });
+    result.parseUs = averageUs(iterations, [&] {
+      String text(layout.c_str());
+      double start = nowUs();
+      if (JsonReader::loadLayout(std::move(text)) != JsonReader::InputJsonStatus::OK) _exit(1);
+      double us = nowUs() - start;
+      card.garbageCollect();
+      return us;
+    });
+    result.streamUs = averageUs(iterations, [&] {
+      File file = SPIFFS.open(LayoutPath);
+      double start = nowUs();
+      if (JsonReader::readWebsiteComponentsFromStream(file) != JsonReader::InputJsonStatus::OK) _exit(1);
+      double us = nowUs() - start;
+      card.garbageCollect();
+      return us;
+    });
+    String text(layout.c_str());
+    JsonReader::loadLayout(std::move(text));
+    result.saveUs = averageUs(iterations, [&] {
+      File file = SPIFFS.open(SnapshotPath, FILE_WRITE);
+      double start = nowUs();
+      if (!Snapshot::save(file, hashed)) _exit(1);
+      file.flush();
+      return nowUs() - start;
+    });
+    card.garbageCollect();
+    result.snapshotBytes = readFile(SnapshotPath).size();
+    result.loadUs = averageUs(iterations, [&] {
+      File file = SPIFFS.open(SnapshotPath);
+      double start = nowUs();
+      if (Snapshot::load(file, hashed) != Snapshot::Status::OK) _exit(1);
+      double us = nowUs() - start;
+      card.garbageCollect();
+      return us;
+    });
+    SPIFFS.remove(SnapshotPath);
+    SPIFFS.remove(LayoutPath);
+    rmdir(dir);
+    return result;
+  }
+
+  // Website assets on a temporary SPIFFS directory: text cut from main.cpp, stored plain and gzipped by the host's gzip,
+  // the icon plain only. Returns the directory, empty when gzip is missing.
+  String writeAssets() {
+    char dir[] = "/tmp/visuino-assets-XXXXXX";
+    if (mkdtemp(dir) == nullptr) return String();
+    String source;
+    const char* slash = strrchr(__FILE__, '/');
+    String benchDir = slash != nullptr ? String(__FILE__, slash - __FILE__ + 1) : String();
+    FILE* file = fopen((benchDir + "../src/main.cpp").c_str(), "rb");
+    if (file != nullptr) {
+      char buffer[4096];
+      size_t count;
+      while ((count = fread(buffer, 1, sizeof(buffer), file)) > 0) source.concat(buffer, count);
+      fclose(file);
+    }
+    if (source.length() < 100000) source = generateLayout(1000);
+    const struct {
+      const char* path;
+      size_t size;
+    } texts[] = {{"/index.html", 2048}, {"/index.css", 3072}, {"/index.js", 24576}, {"/component.css", 4096},
+                 {"/component.js", 40960}, {"/Libs/pureknobMin.js", 12288}};
+    SPIFFS.setRoot(dir);
+    mkdir((String(dir) + "/Libs").c_str(), 0755);
+    size_t offset = 0;
+    for (const auto& text : texts) {
+      writeFile(text.path, reinterpret_cast<const uint8_t*>(source.c_str()) + offset, text.size);
+      offset += text.size;
+      String command = String("gzip -9 -n -k -f '") + SPIFFS.hostPath(text.path) + "' 2>/dev/null";
+      if (system(command.c_str()) != 0) return String();
+    }
+    uint8_t icon[1150];
+    for (size_t i = 0; i < sizeof(icon); i++) icon[i] = static_cast<uint8_t>((i * 2654435761u) >> 13);
+    writeFile("/favicon.ico", icon, sizeof(icon));
+    return String(dir);
+  }
+
+  void removeAssets(const String& dir) {
+    String command = String("rm -rf '") + dir + "'";
+    if (system(command.c_str()) != 0) fprintf(stderr, "could not remove %s\n", dir.c_str());
+  }
+
+  struct AssetReply {
+    int code;
+    String body;
+    String etag;
+    String encoding;
+    String cacheControl;
+    bool varies;
+  };
+
+  AssetReply getAsset(const char* uri, const char* acceptEncoding, const String& ifNoneMatch) {
+    AsyncWebServerRequest request(HTTP_GET, uri);
+    if (acceptEncoding != nullptr) request.addHeader("Accept-Encoding", acceptEncoding);
+    if (!ifNoneMatch.isEmpty()) request.addHeader("If-None-Match", ifNoneMatch);
+    server.handle(request);
+    AsyncWebServerResponse* response = request.response();
+    auto header = [response] (const char* name) {
+      const AsyncWebHeader* found = response->getHeader(name);
+      return found != nullptr ? found->value() : String();
+    };
+    return AssetReply {response->code(), response->drain(), header("ETag"), header("Content-Encoding"), header("Cache-Control"),
+                       response->getHeader("Vary") != nullptr};
+  }
+
+  bool sameBytes(const String& body, const char* path) {
+    std::vector<uint8_t> stored = readFile(path);
+    return body.length() == stored.size() && !memcmp(body.c_str(), stored.data(), stored.size());
+  }
+
+  // Variant choice, validators and cache headers of the asset handlers
+  bool checkAssets() {
+    String dir = writeAssets();
+    if (dir.isEmpty()) {
+      printf("gzip not found, asset checks skipped\n");
+      return true;
+    }
+    SPIFFS.remove("/index.html.gz");                            // plain only
+    SPIFFS.remove("/component.js");                             // gzip only
+    SPIFFS.remove("/index.css");
+    SPIFFS.remove("/index.css.gz");                             // missing
+    WebsiteServer::ServerInit();
+    bool ok = true;
+    auto expect = [&ok] (bool condition, const char* what) {
+      if (!condition) fprintf(stderr, "assets: %s\n", what);
+      ok &= condition;
+    };
+    AssetReply page = getAsset("/", "gzip, deflate", String());
+    expect(page.code == 200 && sameBytes(page.body, "/index.html") && page.encoding.isEmpty(), "plain page");
+    expect(page.cacheControl == "no-cache" && page.etag.startsWith("\"") && !page.varies, "page headers");
+
+    AssetReply gzipped = getAsset("/index.js", "gzip, deflate, br", String());
+    expect(gzipped.code == 200 && gzipped.encoding == "gzip" && sameBytes(gzipped.body, "/index.js.gz"), "gzip variant");
+    expect(gzipped.varies && gzipped.cacheControl.startsWith("public, max-age="), "gzip headers");
+    AssetReply plain = getAsset("/index.js", nullptr, String());
+    expect(plain.code == 200 && plain.encoding.isEmpty() && sameBytes(plain.body, "/index.js") && plain.etag != gzipped.etag,
+           "plain variant");
+    expect(getAsset("/index.js", "gzip;q=0, identity", String()).encoding.isEmpty(), "gzip refused");
+    expect(getAsset("/component.js", nullptr, String()).encoding == "gzip", "gzip only");
+
+    AssetReply cached = getAsset("/index.js", "gzip", gzipped.etag);
+    expect(cached.code == 304 && cached.body.isEmpty() && cached.etag == gzipped.etag, "304");
+    expect(getAsset("/index.js", "gzip", String("\"0\", W/") + gzipped.etag).code == 304, "weak tag in a list");
+    expect(getAsset("/index.js", nullptr, gzipped.etag).code == 200, "tag of the other variant");
+    expect(getAsset("/index.css", "gzip", String()).code == 404, "missing asset");
+    removeAssets(dir);
+    SPIFFS.setRoot("");
+    return ok;
+  }
+
+  // Every asset in both encodings served from the bundle, from RAM and one by one must be the same bytes and headers.
+  // A damaged bundle is packed again at the next ServerInit().
+  bool checkAssetBundle() {
+    String dir = writeAssets();
+    if (dir.isEmpty()) {
+      printf("gzip not found, bundle checks skipped\n");
+      return true;
+    }
+    WebsiteServer::ServerInit();
+    bool ok = static_cast<bool>(Assets::bundle);
+    auto expect = [&ok] (bool condition, const char* what) {
+      if (!condition) fprintf(stderr, "asset bundle: %s\n", what);
+      ok &= condition;
+    };
+    expect(ok, "bundle not packed");
+    const char* encodings[] = {"gzip", nullptr};
+    std::vector<AssetReply> bundled;
+    uint32_t opens = SPIFFS.openCount();
+    for (int pass = 0; pass < 3; pass++) {                       // bundle, bundle again - cached from the second request - and RAM
+      for (const Assets::Asset& asset : Assets::Files) {
+        for (const char* encoding : encodings) bundled.push_back(getAsset(asset.uri, encoding, String()));
+      }
+    }
+    expect(SPIFFS.openCount() == opens, "bundle requests opened files");
+    expect(Assets::variants[1].gzip.cached && Assets::variants[6].plain.cached, "small assets not kept in RAM");
+    expect(!Assets::variants[4].gzip.cached && Assets::cacheUsed <= Assets::cacheCapacity, "cache over its capacity");
+    Assets::bundle.close();
+    size_t at = 0;
+    for (int pass = 0; pass < 3; pass++) {
+      for (const Assets::Asset& asset : Assets::Files) {
+        for (const char* encoding : encodings) {
+          AssetReply file = getAsset(asset.uri, encoding, String());
+          const AssetReply& reply = bundled[at++];
+          bool same = reply.code == file.code && reply.body == file.body && reply.etag == file.etag && reply.encoding == file.encoding
+                      && reply.varies == file.varies;
+          if (!same) fprintf(stderr, "asset bundle: %s %s differs from the file\n", asset.uri, encoding ? encoding : "plain");
+          ok &= same;
+        }
+      }
+    }
+
+    std::vector<uint8_t> packed = readFile(Assets::BundlePath);
+    writeFile(Assets::BundlePath, packed.data(), packed.size() / 2);
+    WebsiteServer::ServerInit();
+    expect(Assets::bundle && readFile(Assets::BundlePath) == packed, "truncated bundle not packed again");
+    bundled[0] = getAsset(Assets::Files[0].uri, encodings[0], String());
+    expect(bundled[0].code == 200 && sameBytes(bundled[0].body, "/index.html.gz"), "repacked bundle content");
+    removeAssets(dir);
+    SPIFFS.setRoot("");
+    return ok;
+  }
+
+  enum class AssetSource {FILES, BUNDLE, CACHED};
+
+  struct AssetServeResult {
+    const char* source;
+    size_t clients;
+    uint32_t requests;
+    uint32_t failed;                      // no file handle left, answered 404
+    double opensPerPage;
+    double us;                            // per request, handled and sent
+  };
+
+  // Each client asks for the page and every asset at once, like a browser over parallel connections. The responses stay
+  // open while they are sent a TCP segment at a time, round robin over all of them, as AsyncTCP does.
+  AssetServeResult serveAssets(const char* name, AssetSource source, size_t clients, uint16_t rounds) {
+    AssetServeResult result = {name, clients, 0, 0, 0, 0};
+    Assets::cacheCapacity = source == AssetSource::CACHED ? ASSET_CACHE_BYTES : 0;
+    Assets::begin();
+    if (source == AssetSource::FILES) Assets::bundle.close();
+    std::vector<uint8_t> segment(1436);
+    uint32_t opens = 0;
+    for (uint16_t round = 0; round <= rounds; round++) {         // round 0 warms the cache up
+      std::vector<std::unique_ptr<AsyncWebServerRequest>> requests;
+      uint32_t openedBefore = SPIFFS.openCount();
+      double start = nowUs();
+      for (size_t client = 0; client < clients; client++) {
+        for (const Assets::Asset& asset : Assets::Files) {
+          requests.emplace_back(new AsyncWebServerRequest(HTTP_GET, asset.uri));
+          requests.back()->addHeader("Accept-Encoding", "gzip, deflate");
+          server.handle(*requests.back());
+        }
+      }
+      std::vector<size_t> sent(requests.size(), 0);
+      for (bool sending = true; sending;) {
+        sending = false;
+        for (size_t i = 0; i < requests.size(); i++) {
+          AsyncWebServerResponse* response = requests[i]->response();
+          if (response->code() != 200 || sent[i] == SIZE_MAX) continue;
+          size_t count = response->fill(segment.data(), segment.size(), sent[i]);
+          sent[i] = count > 0 ? sent[i] + count : SIZE_MAX;
+          sending = true;
+        }
+      }
+      double us = nowUs() - start;
+      if (round == 0) continue;
+      result.us += us;
+      opens += SPIFFS.openCount() - openedBefore;
+      for (const auto& request : requests) {
+        result.requests++;
+        if (request->response()->code() != 200) result.failed++;
+      }
+    }
+    result.us /= result.requests;
+    result.opensPerPage = static_cast<double>(opens) / (rounds * clients);
+    Assets::cacheCapacity = ASSET_CACHE_BYTES;
+    return result;
+  }
+
+  struct PageLoadResult {
+    const char* scenario;
+    uint16_t requests;
+    uint16_t notModified;
+    size_t responseBytes;                 // status line, headers and body
+    double serverUs;
+  };
+
+  size_t responseBytes(const AssetReply& reply, AsyncWebServerRequest& request) {
+    AsyncWebServerResponse* response = request.response();
+    size_t bytes = strlen("HTTP/1.1 200 OK\r\n") + strlen("Content-Type: \r\n") + response->contentType().length() + 2;
+    if (reply.code == 200) bytes += strlen("Content-Length: \r\n") + String(static_cast<unsigned long>(reply.body.length())).length();
+    const char* names[] = {"ETag", "Cache-Control", "Content-Encoding", "Vary"};
+    for (const char* name : names) {
+      const AsyncWebHeader* header = response->getHeader(name);
+      if (header != nullptr) bytes += header->name().length() + header->value().length() + 4;
+    }
+    return bytes + reply.body.length();
+  }
+
+  // One page load: the page and every asset, as the old handlers served them (legacy), or through Assets::send()
+  // with gzip accepted and, on a reload, the ETags of the previous load. Within max-age a browser asks only for the page.
+  PageLoadResult loadPage(const char* scenario, bool legacy, bool reload, bool withinMaxAge, std::vector<String>& etags) {
+    PageLoadResult result = {scenario, 0, 0, 0, 0};
+    etags.resize(Assets::FileCount);
+    for (size_t i = 0; i < Assets::FileCount; i++) {
+      if (withinMaxAge && Assets::Files[i].cacheControl != Assets::NoCache) continue;
+      AsyncWebServerRequest request(HTTP_GET, Assets::Files[i].uri);
+      request.addHeader("Accept-Encoding", "gzip, deflate");
+      if (reload && !legacy) request.addHeader("If-None-Match", etags[i]);
+      double start = nowUs();
+      if (legacy) request.send(SPIFFS, Assets::Files[i].path, Assets::Files[i].contentType);
+      else server.handle(request);
+      AssetReply reply = {request.response()->code(), request.response()->drain(), String(), String(), String(), false};
+      result.serverUs += nowUs() - start;
+      const AsyncWebHeader* etag = request.response()->getHeader("ETag");
+      if (etag != nullptr) etags[i] = etag->value();
+      result.requests++;
+      if (reply.code == 304) result.notModified++;
+      result.responseBytes += responseBytes(reply, request);
+    }
+    return result;
+  }
+
+  // /input splices the cached static fields with the current dynamic ones, every element must match toWebsiteJson().
+  // A Label text longer than the on-stack buffer takes the fallback path.
+  bool checkStaticJsonCache() {
+    WebsiteServer::ServerInit();
+    String layout = generateLayout(40);
+    JsonReader::readWebsiteComponentsFromJson(layout);
+    for (const String& update : outputUpdates(layout, 7)) JsonReader::readWebsiteComponentsFromJson(update);
+    String longText;
+    for (int i = 0; i < 100; i++) longText += static_cast<char>('a' + i % 26);
+    JsonReader::readWebsiteComponentsFromJson(String("{\"elements\":[{\"name\":\"Info_8\",\"componentType\":\"label\",\"value\":\"") + longText + "\"}]}");
+
+    AsyncWebServerRequest request(HTTP_GET, "/input");
+    server.handle(request);
+    String body = request.response() ? request.response()->drain(97) : String();
+    DynamicJsonDocument doc(body.length() * 2 + 64);
+    if (deserializeJson(doc, body)) {
+      fprintf(stderr, "static cache: /input is not valid JSON\n");
+      return false;
+    }
+    size_t checked = 0;
+    bool sawLongText = false;
+    for (JsonObjectConst element : doc[JsonKey::Elements].as<JsonArrayConst>()) {
+      Website::WebsiteComponent* component = nullptr;
+      for (uint16_t id = 0; (component = card.getComponentById(id)) != nullptr; id++) {
+        if (!strcmp(component->getName(), element[JsonKey::Name].as<const char*>())) break;
+      }
+      if (component == nullptr) return false;
+      String expected;
+      serializeJson(component->toWebsiteJson(), expected);
+      DynamicJsonDocument expectedDoc(expected.length() * 2 + 64);
+      deserializeJson(expectedDoc, expected);
+      JsonObjectConst reference = expectedDoc.as<JsonObjectConst>();
+      bool same = reference.size() == element.size();
+      for (JsonPairConst field : reference) {
+        String a, b;
+        serializeJson(field.value(), a);
+        serializeJson(element[field.key().c_str()], b);
+        same &= a == b;
+      }
+      if (!same) {
+        fprintf(stderr, "static cache: %s differs from toWebsiteJson()\n", component->getName());
+        return false;
+      }
+      sawLongText |= longText == element[JsonKey::Value].as<const char*>();
+      checked++;
+    }
+    if (checked != 40 || !sawLongText) {
+      fprintf(stderr, "static cache: %zu elements checked, long label %s\n", checked, sawLongText ? "found" : "missing");
+      return false;
+    }
+    return true;
+  }
+
+  struct CacheResult {
+    size_t components;
+    double rebuildUs;                     // per request, every component through toWebsiteJson() + serializeJson(), the pre-cache path
+    double cachedUs;                      // per request, the real /input handler
+  };
+
+  // Whole-layout /input: the cached static JSON against rebuilding every component object in the component memory
+  CacheResult compareInputCache(size_t count, uint16_t iterations) {
+    CacheResult result = {count, 0, 0};
+    WebsiteServer::ServerInit();
+    JsonReader::readWebsiteComponentsFromJson(generateLayout(count));
+    std::vector<char> segment(1436);
+    volatile size_t sink = 0;
+    double start = nowUs();
+    for (uint16_t i = 0; i < iterations; i++) {
+      size_t bytes = 0;
+      Website::WebsiteComponent* component;
+      for (uint16_t id = 0; (component = card.getComponentById(id)) != nullptr; id++) {
+        CommonJsonMemory::Guard guard(Website::WebsiteComponent::getJsonMemory());
+        bytes += serializeJson(component->toWebsiteJson(), segment.data(), segment.size());
+      }
+      sink = bytes;
+    }
+    result.rebuildUs = (nowUs() - start) / iterations;
+    start = nowUs();
+    for (uint16_t i = 0; i < iterations; i++) {
+      AsyncWebServerRequest request(HTTP_GET, "/input");
+      server.handle(request);
+      sink = discard(request.response());
+    }
+    result.cachedUs = (nowUs() - start) / iterations;
+    (void)sink;
+    return result;
+  }
+
+  void printHeader() {
+    printf("%10s %10s %12s %10s %10s %12s %10s %10s %10s %12s\n",
+           "components", "json_B", "parse_us", "input_us", "input_B", "input_heap_B", "status_us", "delta_us", "delta_B", "peak_heap_B");
+  }
+
+  void printResult(const Result& r) {
+    printf("%10zu %10zu %12.1f %10.1f %10zu %12zu %10.2f %10.1f %10zu %12zu\n",
+           r.components, r.jsonBytes, r.parseUs, r.inputUs, r.inputBytes, r.inputPeak, r.statusUs, r.deltaUs, r.deltaBytes, r.peakHeap);
+  }
+
+  // Runs fn in a child process so every measurement starts from a freshly booted state
+  template <typename Fn> bool isolated(Fn fn) {
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid < 0) return false;
+    if (pid == 0) {
+      fn();
+      fflush(stdout);
+      _exit(0);
+    }
+    int status = 0;
+    waitpid(pid, &status, 0);
+    return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+  }
+}
+
+int main(int argc, char** argv) {
+  std::vector<size_t> sizes;
+  uint16_t iterations = Bench::DefaultIterations;
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "--iterations") && i + 1 < argc) iterations = static_cast<uint16_t>(atoi(argv[++i]));
+    else sizes.push_back(static_cast<size_t>(atol(argv[i])));
+  }
+  if (sizes.empty()) sizes = {10, 100, 1000, 5000};
+  if (iterations == 0) iterations = 1;
+
+  Serial.begin(VISUINO_BAUD_RATE);
+  if (!Bench::checkTypeDispatch()) return 1;
+  if (!Bench::checkIndexCapacity()) return 1;
+  if (!Bench::isolated([] {if (!Bench::checkChunkedInput()) _exit(1);})) return 1;
+  if (!Bench::isolated([] {if (!Bench::checkEventCoalescing()) _exit(1);})) return 1;
+  if (!Bench::isolated([] {if (!Bench::checkStaticJsonCache()) _exit(1);})) return 1;
+  if (!Bench::isolated([] {if (!Bench::checkStatusBatch()) _exit(1);})) return 1;
+  if (!Bench::isolated([] {if (!Bench::checkPendingRoom()) _exit(1);})) return 1;
+  if (!Bench::isolated([] {if (!Bench::checkBodyReassembly()) _exit(1);})) return 1;
+  if (!Bench::isolated([] {if (!Bench::checkMetrics()) _exit(1);})) return 1;
+  if (!Bench::isolated([] {if (!Bench::checkLog()) _exit(1);})) return 1;
+  if (!Bench::isolated([] {if (!Bench::checkSerialOutput()) _exit(1);})) return 1;
+  if (!Bench::isolated([] {if (!Bench::checkJsonCapacity()) _exit(1);})) return 1;
+  if (!Bench::isolated([] {if (!Bench::checkInPlaceLayout(Bench::generateLayout(40))) _exit(1);})) return 1;
+  if (!Bench::isolated([] {if (!Bench::checkInPlaceLayout(Bench::escapedLayout())) _exit(1);})) return 1;
+  if (!Bench::checkStreamedLayouts()) return 1;
+  if (!Bench::checkSnapshots()) return 1;
+  if (!Bench::isolated([] {if (!Bench::checkAssets()) _exit(1);})) return 1;
+  if (!Bench::isolated([] {if (!Bench::checkAssetBundle()) _exit(1);})) return 1;
+  if (!Bench::checkVisuinoFraming()) return 1;
+  printf("Layout load and request handling, %u iterations per request type\n", iterations);
+  Bench::printHeader();
+  bool ok = true;
+  for (size_t size : sizes) {
+    ok &= Bench::isolated([&] {Bench::printResult(Bench::run(size, iterations));});
+  }
+
+  printf("\n/events push, 100 components, one output update per tick\n");
+  printf("%10s %10s %12s %16s %14s %12s %10s\n", "clients", "push_us", "publish_us", "heap_per_client_B", "queued_heap_B", "events", "dropped");
+  const size_t clientCounts[] = {1, 4, 8};
+  for (size_t clients : clientCounts) {
+    ok &= Bench::isolated([&] {
+      Bench::EventsResult r = Bench::runEvents(clients, iterations);
+      printf("%10zu %10.1f %12.1f %16zu %14zu %12u %10u\n",
+             r.clients, r.pushUs, r.publishUs, r.heapPerClient, r.queuedHeap, r.eventsPerClient, r.dropped);
+    });
+  }
+
+  printf("\nSlider drag input, 100 components, 10 values per slider per tick\n");
+  printf("%10s %14s %18s %14s %18s\n", "messages", "status_msg_s", "status_forwarded", "ws_msg_s", "ws_forwarded");
+  ok &= Bench::isolated([&] {
+    Bench::InputChannelResult r = Bench::runInputChannels(iterations, 10);
+    printf("%10u %14.0f %18llu %14.0f %18llu\n", r.messages, r.statusPerSecond, static_cast<unsigned long long>(r.statusForwarded),
+           r.wsPerSecond, static_cast<unsigned long long>(r.wsForwarded));
+  });
+
+  // every POST also pays a round trip over the softAP, 5 ms assumed here, which the host stand-ins do not have
+  printf("\n/status control updates, 100 components, one message per POST vs arrays of messages\n");
+  printf("%10s %10s %12s %12s %14s %18s\n", "batch", "updates", "body_B_upd", "server_us", "updates_s", "updates_s_rtt5ms");
+  const size_t batchSizes[] = {0, 1, 2, 4, 8, 16, 32, 64};
+  for (size_t batch : batchSizes) {
+    ok &= Bench::isolated([&] {
+      Bench::StatusBatchResult r = Bench::runStatusBatches(batch, std::max<uint16_t>(iterations, 20));
+      double perPost = std::max<size_t>(batch, 1);
+      printf("%10s %10u %12zu %12.1f %14.0f %18.0f\n", batch == 0 ? "single" : String(static_cast<unsigned long>(batch)).c_str(),
+             r.updates, r.bodyBytesPerUpdate, r.serverUs, perPost * 1e6 / r.serverUs, perPost * 1e6 / (r.serverUs + 5000));
+    });
+  }
+
+  // 8N1: ten bits on the wire per byte, latency = encoding + wire time
+  printf("\nVisuino link, bytes and latency per event (8N1)\n");
+  printf("%12s %8s %8s %16s %16s %18s %18s\n", "type", "json_B", "frame_B", "json_ms@9600", "frame_ms@9600", "json_ms@115200", "frame_ms@115200");
+  ok &= Bench::isolated([&] {
+    for (const Bench::LinkResult& r : Bench::runVisuinoLink(iterations)) {
+      auto latencyMs = [] (size_t bytes, double encodeUs, double baud) {return encodeUs / 1000.0 + bytes * 10 * 1000.0 / baud;};
+      printf("%12s %8zu %8zu %16.2f %16.2f %18.3f %18.3f\n", r.type, r.jsonBytes, r.binaryBytes,
+             latencyMs(r.jsonBytes, r.encodeJsonUs, 9600), latencyMs(r.binaryBytes, r.encodeBinaryUs, 9600),
+             latencyMs(r.jsonBytes, r.encodeJsonUs, 115200), latencyMs(r.binaryBytes, r.encodeBinaryUs, 115200));
+    }
+  });
+
+  printf("\nVisuino event queue stress, %u slots, one consumer thread\n", WebsiteServer::Visuino::EventQueue::Capacity);
+  printf("%10s %10s %10s %10s %8s %10s %12s %12s %14s\n", "producers", "events", "enqueued", "coalesced", "dropped", "delivered",
+         "out_of_order", "wrong_final", "events_s");
+  const uint32_t producerCounts[] = {1, 2, 4, 8};
+  for (uint32_t producers : producerCounts) {
+    Bench::QueueStressResult r = Bench::stressVisuinoQueue(producers, 200000, 50);
+    printf("%10u %10u %10u %10u %8u %10u %12u %12u %14.0f\n", r.producers, r.events, r.enqueued, r.coalesced, r.dropped, r.delivered,
+           r.outOfOrder, r.wrongFinal, r.eventsPerSecond);
+    ok &= Bench::checkQueueStress(r);
+  }
+
+  printf("\nLayout load heap, strings copied into the document vs parsed in place and kept by the card\n");
+  printf("%10s %10s %14s %16s %14s %16s\n", "components", "json_B", "copied_peak_B", "copied_resident_B", "inplace_peak_B", "inplace_resident_B");
+  for (size_t size : sizes) {
+    Bench::LoadHeapResult r = {size, 0, 0, 0, 0, 0};
+    String layout = Bench::generateLayout(size);
+    r.textBytes = layout.length();
+    // each path in its own process, the numbers come back through a pipe
+    size_t measured[4] = {};
+    for (int path = 0; path < 2; path++) {
+      int fds[2];
+      if (pipe(fds) != 0) return 1;
+      ok &= Bench::isolated([&] {
+        size_t values[2];
+        Bench::measureLoad(layout, path == 1, values[0], values[1]);
+        if (write(fds[1], values, sizeof(values)) != sizeof(values)) _exit(1);
+      });
+      if (read(fds[0], measured + path * 2, 2 * sizeof(size_t)) != 2 * sizeof(size_t)) ok = false;
+      close(fds[0]);
+      close(fds[1]);
+    }
+    r.copiedPeak = measured[0];
+    r.copiedResident = measured[1];
+    r.inPlacePeak = measured[2];
+    r.inPlaceResident = measured[3];
+    printf("%10zu %10zu %14zu %16zu %14zu %16zu\n", r.components, r.textBytes, r.copiedPeak, r.copiedResident, r.inPlacePeak, r.inPlaceResident);
+  }
+
+  printf("\nLargest generated layout loading within 40 KB of free heap\n");
+  printf("%12s %12s %10s\n", "path", "components", "json_B");
+  const struct {
+    const char* name;
+    Bench::LoadPath path;
+  } loadPaths[] = {{"copied", Bench::LoadPath::COPIED}, {"in place", Bench::LoadPath::IN_PLACE}, {"streamed", Bench::LoadPath::STREAMED}};
+  for (const auto& load : loadPaths) {
+    size_t components = Bench::largestLayout(load.path, 40 * 1024);
+    printf("%12s %12zu %10zu\n", load.name, components, Bench::generateLayout(components).length());
+  }
+
+  printf("\nBoot phases, layout in SPIFFS parsed vs loaded from the binary snapshot\n");
+  printf("%10s %10s %12s %10s %10s %10s %10s %12s\n", "components", "json_B", "snapshot_B", "hash_us", "parse_us", "stream_us",
+         "save_us", "snapshot_us");
+  for (size_t size : sizes) {
+    ok &= Bench::isolated([&] {
+      Bench::BootResult r = Bench::measureBoot(size, std::min<uint16_t>(iterations, 20));
+      printf("%10zu %10zu %12zu %10.1f %10.1f %10.1f %10.1f %12.1f\n", r.components, r.jsonBytes, r.snapshotBytes, r.hashUs, r.parseUs,
+             r.streamUs, r.saveUs, r.loadUs);
+    });
+  }
+
+  // 8 bits per byte on the wire, transfer time only - round trips and TCP slow start come on top
+  printf("\nPage load, website assets served plain without validators vs gzipped with ETag and Cache-Control\n");
+  printf("%26s %9s %6s %12s %10s %12s %12s\n", "scenario", "requests", "304s", "response_B", "server_us", "ms@1Mbit/s", "ms@5Mbit/s");
+  ok &= Bench::isolated([&] {
+    String dir = Bench::writeAssets();
+    if (dir.isEmpty()) {
+      printf("gzip not found, skipped\n");
+      return;
+    }
+    WebsiteServer::ServerInit();
+    std::vector<String> etags;
+    const Bench::PageLoadResult results[] = {
+      Bench::loadPage("before, first load", true, false, false, etags),
+      Bench::loadPage("before, reload", true, true, false, etags),
+      Bench::loadPage("after, first load", false, false, false, etags),
+      Bench::loadPage("after, reload", false, true, false, etags),
+      Bench::loadPage("after, within max-age", false, true, true, etags),
+    };
+    for (const Bench::PageLoadResult& r : results) {
+      printf("%26s %9u %6u %12zu %10.1f %12.1f %12.1f\n", r.scenario, r.requests, r.notModified, r.responseBytes, r.serverUs,
+             r.responseBytes * 8 / 1000.0, r.responseBytes * 8 / 5000.0);
+    }
+    Bench::removeAssets(dir);
+  });
+
+  printf("\nWebsite assets, files opened per request vs one packed bundle vs bundle and %u B RAM cache, gzip accepted\n",
+         static_cast<unsigned>(ASSET_CACHE_BYTES));
+  printf("%10s %8s %9s %8s %12s %12s %10s\n", "source", "clients", "requests", "failed", "opens_page", "us_request", "served_s");
+  ok &= Bench::isolated([&] {
+    String dir = Bench::writeAssets();
+    if (dir.isEmpty()) {
+      printf("gzip not found, skipped\n");
+      return;
+    }
+    WebsiteServer::ServerInit();
+    const struct {
+      const char* name;
+      Bench::AssetSource source;
+    } sources[] = {{"files", Bench::AssetSource::FILES}, {"bundle", Bench::AssetSource::BUNDLE}, {"cached", Bench::AssetSource::CACHED}};
+    const size_t assetClients[] = {1, 4, 8};
+    for (size_t clients : assetClients) {
+      for (const auto& source : sources) {
+        Bench::AssetServeResult r = Bench::serveAssets(source.name, source.source, clients, iterations);
+        printf("%10s %8zu %9u %8u %12.1f %12.1f %10.0f\n", r.source, r.clients, r.requests, r.failed, r.opensPerPage, r.us,
+               1e6 / r.us * (r.requests - r.failed) / r.requests);
+      }
+    }
+    Bench::removeAssets(dir);
+  });
+
+  printf("\n/metrics, cost of one timed request and of a scrape\n");
+  printf("%12s %12s %12s\n", "record_ns", "scrape_us", "scrape_B");
+  ok &= Bench::isolated([&] {
+    Bench::MetricsResult r = Bench::measureMetrics(1000000);
+    printf("%12.1f %12.1f %12zu\n", r.recordNs, r.scrapeUs, r.scrapeBytes);
+  });
+
+  printf("\nOne error repeating for 60 s, text log with a memory report per error vs binary ring, serial at %u baud\n",
+         static_cast<unsigned>(VISUINO_BAUD_RATE));
+  printf("%10s %12s %12s %12s %12s\n", "errors_s", "text_B", "ring_B", "text_link_%", "ring_link_%");
+  const uint32_t errorRates[] = {1, 10, 100};
+  for (uint32_t rate : errorRates) {
+    ok &= Bench::isolated([&] {
+      Bench::LogLoadResult r = Bench::replayErrorLog(rate);
+      double linkBytes = VISUINO_BAUD_RATE / 10.0 * 60;
+      printf("%10u %12llu %12llu %12.1f %12.1f\n", r.errorsPerSecond, static_cast<unsigned long long>(r.textBytes),
+             static_cast<unsigned long long>(r.ringBytes), r.textBytes * 100 / linkBytes, r.ringBytes * 100 / linkBytes);
+    });
+  }
+
+  printf("\nSerial link at %u baud, 128 B TX FIFO, 10 s: /status switch every 50 ms, /ws slider drag every 5 ms, an error every 100 ms\n",
+         static_cast<unsigned>(VISUINO_BAUD_RATE));
+  printf("%10s %12s %12s %10s %14s %10s %12s %8s %12s\n", "mode", "loop_max_ms", "blocked_ms", "control", "control_max_ms",
+         "state", "state_max_ms", "log", "log_max_ms");
+  for (bool scheduled : {false, true}) {
+    ok &= Bench::isolated([&] {
+      Bench::SerialLinkResult r = Bench::runSerialLink(scheduled);
+      printf("%10s %12.1f %12.1f %10u %14.1f %10u %12.1f %8u %12.1f\n", r.mode, r.loopMaxUs / 1e3, r.blockedUs / 1e3, r.controlLines,
+             r.controlMaxUs / 1e3, r.stateLines, r.stateMaxUs / 1e3, r.logLines, r.logMaxUs / 1e3);
+    });
+  }
+
+  printf("\nLayout document capacity, 2x the JSON length vs counted from the text\n");
+  printf("%10s %10s %10s %14s %10s %10s %10s\n", "layout", "components", "json_B", "heuristic_B", "exact_B", "used_B", "2x_fits");
+  for (size_t size : sizes) {
+    ok &= Bench::isolated([&] {
+      const Bench::CapacityResult results[] = {Bench::compareCapacity("generated", Bench::generateLayout(size), size),
+                                               Bench::compareCapacity("compact", Bench::compactLayout(size), size)};
+      for (const Bench::CapacityResult& r : results) {
+        printf("%10s %10zu %10zu %14zu %10zu %10zu %10s\n", r.layout, r.components, r.jsonBytes, r.heuristicBytes, r.exactBytes,
+               r.usedBytes, r.heuristicFits ? "yes" : "no");
+      }
+    });
+  }
+
+  printf("\n/input whole layout, components rebuilt per request vs static JSON cache\n");
+  printf("%10s %12s %12s %12s %12s\n", "components", "rebuild_us", "cached_us", "rebuild_req_s", "cached_req_s");
+  for (size_t size : sizes) {
+    ok &= Bench::isolated([&] {
+      Bench::CacheResult r = Bench::compareInputCache(size, iterations);
+      printf("%10zu %12.1f %12.1f %12.0f %12.0f\n", r.components, r.rebuildUs, r.cachedUs, 1e6 / r.rebuildUs, 1e6 / r.cachedUs);
+    });
+  }
+
+  printf("\nComponent walks, per component: changed-output scan and toWebsiteJson in layout order\n");
+  printf("%10s %14s %14s\n", "components", "walk_ns", "json_ns");
+  const size_t walkSizes[] = {100, 1000, 5000};
+  for (size_t size : walkSizes) {
+    ok &= Bench::isolated([&] {
+      Bench::WalkResult r = Bench::walkComponents(size, iterations);
+      printf("%10zu %14.2f %14.1f\n", r.components, r.walkNs, r.jsonNs);
+    });
+  }
+
+  printf("\nString pool, generated layouts\n");
+  printf("%10s %12s %12s %14s %14s\n", "components", "distinct", "shared", "arena_used_B", "arena_size_B");
+  const size_t poolSizes[] = {1000, 5000};
+  for (size_t size : poolSizes) {
+    ok &= Bench::isolated([&] {Bench::printStringPool(size);});
+  }
+
+  printf("\nHeap after layout load, sample layout on a 160 KB heap, synthetic layout on a 1 MB heap\n");
+  printf("%10s %12s %12s %14s %8s %14s %16s %10s\n", "components", "load_allocs", "free_B", "largest_free_B", "frag_%",
+         "cleared_free_B", "cleared_largest_B", "cleared_%");
+  const size_t heapSizes[] = {160 * 1024, 1024 * 1024};
+  for (size_t heapSize : heapSizes) {
+    ok &= Bench::isolated([&] {
+      String source = heapSize == heapSizes[0] ? WebsiteServer::testWebsiteConfigStr : Bench::generateLayout(1000);
+      Bench::HeapLayoutResult r = Bench::heapAfterLayout(source, heapSize);
+      printf("%10zu %12u %12zu %14zu %8u %14zu %16zu %10u\n", r.components, r.allocations, r.loadedFree, r.loadedLargest,
+             r.loadedFragmentation, r.clearedFree, r.clearedLargest, r.clearedFragmentation);
+    });
+  }
+
+  printf("\nCommonJsonMemory contention, Guard per attempt\n");
+  printf("%10s %10s %10s %10s %10s %10s %14s %10s\n", "threads", "wait_ms", "attempts", "owned", "failures", "overlaps",
+         "longest_hold_us", "guard_ns");
+  const uint32_t contention[][2] = {{1, 0}, {2, 0}, {4, 0}, {4, 1}};
+  for (const auto& c : contention) {
+    Bench::MemoryContentionResult r = Bench::contendJsonMemory(c[0], c[1] ? 2000 : 200000, c[1]);
+    printf("%10u %10u %10u %10u %10u %10u %14u %10.1f\n", r.threads, c[1], r.attempts, r.owned, r.stats.failures, r.overlaps,
+           r.stats.longestHoldUs, r.guardNs);
+    ok &= Bench::checkMemoryContention(r);
+  }
+
+  printf("\nName lookup and name equality, strcmp vs pooled name handles\n");
+  printf("%10s %12s %12s %12s %12s\n", "components", "linear_ns", "pool_ns", "strcmp_eq_ns", "handle_eq_ns");
+  for (size_t size : sizes) ok &= Bench::isolated([&] {if (!Bench::lookupComparison(size, 20000)) _exit(1);});
+  return ok ? 0 : 1;
+}
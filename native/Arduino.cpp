@@ -0,0 +1,52 @@
+#include "Arduino.h"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+EspClass ESP;
+
+namespace {
+  const std::chrono::steady_clock::time_point bootTime = std::chrono::steady_clock::now();
+  std::atomic<bool> manualClock {false};
+  std::atomic<uint64_t> manualUs {0};
+
+  uint64_t elapsedUs() {
+    if (manualClock.load(std::memory_order_relaxed)) return manualUs.load(std::memory_order_relaxed);
+    auto elapsed = std::chrono::steady_clock::now() - bootTime;
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count());
+  }
+}
+
+namespace NativeClock {
+  // starts from the real time, so the clock keeps going forward when switched
+  void setManual(bool manual) {
+    if (manual == manualClock.load()) return;
+    if (manual) manualUs.store(elapsedUs());
+    manualClock.store(manual);
+  }
+
+  void advance(uint64_t us) {manualUs.fetch_add(us);}
+}
+
+uint32_t millis() {
+  return static_cast<uint32_t>(elapsedUs() / 1000);
+}
+
+uint32_t micros() {
+  return static_cast<uint32_t>(elapsedUs());
+}
+
+void delay(uint32_t ms) {
+  if (manualClock.load(std::memory_order_relaxed)) NativeClock::advance(ms * 1000ull);
+  else std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+void delayMicroseconds(uint32_t us) {
+  if (manualClock.load(std::memory_order_relaxed)) NativeClock::advance(us);
+  else std::this_thread::sleep_for(std::chrono::microseconds(us));
+}
+
+void yield() {
+  std::this_thread::yield();
+}
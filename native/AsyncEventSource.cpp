@@ -0,0 +1,98 @@
+#include "AsyncEventSource.h"
+
+namespace {
+  String eventMessage(const char* message, const char* event, uint32_t id, uint32_t reconnect) {
+    String out;
+    if (reconnect) {
+      out += "retry: ";
+      out += String(static_cast<unsigned long>(reconnect));
+      out += "\r\n";
+    }
+    if (id) {
+      out += "id: ";
+      out += String(static_cast<unsigned long>(id));
+      out += "\r\n";
+    }
+    if (event != nullptr) {
+      out += "event: ";
+      out += event;
+      out += "\r\n";
+    }
+    if (message != nullptr) {
+      out += "data: ";
+      out += message;
+      out += "\r\n";
+    }
+    out += "\r\n";
+    return out;
+  }
+}
+
+void AsyncEventSourceClient::send(const char* message, const char* event, uint32_t id, uint32_t reconnect) {
+  if (!isConnected) return;
+  if (queue.size() >= SSE_MAX_QUEUED_MESSAGES) {
+    droppedCount++;
+    return;
+  }
+  queue.push_back(eventMessage(message, event, id, reconnect));
+}
+
+std::vector<String> AsyncEventSourceClient::drain() {
+  std::vector<String> messages(queue.begin(), queue.end());
+  queue.clear();
+  return messages;
+}
+
+
+void AsyncEventSource::close() {
+  for (auto& client : connected) client->close();
+  connected.clear();
+}
+
+void AsyncEventSource::send(const char* message, const char* event, uint32_t id, uint32_t reconnect) {
+  for (auto& client : connected) client->send(message, event, id, reconnect);
+}
+
+size_t AsyncEventSource::count() const {
+  size_t count = 0;
+  for (auto& client : connected) {
+    if (client->connected()) count++;
+  }
+  return count;
+}
+
+size_t AsyncEventSource::avgPacketsWaiting() const {
+  size_t waiting = 0;
+  size_t clients = 0;
+  for (auto& client : connected) {
+    if (!client->connected()) continue;
+    waiting += client->packetsWaiting();
+    clients++;
+  }
+  return clients ? (waiting + clients - 1) / clients : 0;
+}
+
+bool AsyncEventSource::canHandle(AsyncWebServerRequest* request) {
+  return request->method() == HTTP_GET && request->url() == sourceUrl;
+}
+
+void AsyncEventSource::handleRequest(AsyncWebServerRequest* request) {
+  String lastId = request->header("Last-Event-ID");
+  connect(static_cast<uint32_t>(strtoul(lastId.c_str(), nullptr, 10)));
+}
+
+AsyncEventSourceClient* AsyncEventSource::connect(uint32_t lastId) {
+  connected.emplace_back(new AsyncEventSourceClient(this, lastId));
+  AsyncEventSourceClient* client = connected.back().get();
+  if (connectHandler) connectHandler(client);
+  return client;
+}
+
+void AsyncEventSource::disconnect(AsyncEventSourceClient* client) {
+  for (auto it = connected.begin(); it != connected.end(); ++it) {
+    if (it->get() == client) {
+      connected.erase(it);
+      return;
+    }
+  }
+}
@@ -0,0 +1,71 @@
+#ifndef NATIVE_ASYNC_EVENT_SOURCE_H
+#define NATIVE_ASYNC_EVENT_SOURCE_H
+
+// Host stand-in for AsyncEventSource.
+// Like the library every client keeps its own copy of each queued message, up to SSE_MAX_QUEUED_MESSAGES,
+// newer messages are dropped while the queue is full. The host plays the network by draining clients.
+
+#include <deque>
+#include <functional>
+#include <memory>
+#include <vector>
+#include "ESPAsyncWebServer.h"
+
+#ifndef SSE_MAX_QUEUED_MESSAGES
+#define SSE_MAX_QUEUED_MESSAGES 32
+#endif
+
+class AsyncEventSource;
+class AsyncEventSourceClient;
+
+typedef std::function<void(AsyncEventSourceClient* client)> ArEventHandlerFunction;
+
+class AsyncEventSourceClient {
+public:
+  AsyncEventSourceClient(AsyncEventSource* server, uint32_t lastId) : server(server), lastEventId(lastId) {}
+
+  void send(const char* message, const char* event = nullptr, uint32_t id = 0, uint32_t reconnect = 0);
+  void close() {isConnected = false;}
+  bool connected() const {return isConnected;}
+  uint32_t lastId() const {return lastEventId;}
+  size_t packetsWaiting() const {return queue.size();}
+
+  // host side: hands the queued messages to the "network"
+  std::vector<String> drain();
+  uint32_t dropped() const {return droppedCount;}
+
+private:
+  AsyncEventSource* server;
+  uint32_t lastEventId;
+  bool isConnected = true;
+  uint32_t droppedCount = 0;
+  std::deque<String> queue;
+};
+
+class AsyncEventSource : public AsyncWebHandler {
+public:
+  explicit AsyncEventSource(const String& url) : sourceUrl(url) {}
+  ~AsyncEventSource() override {close();}
+
+  const char* url() const {return sourceUrl.c_str();}
+  void close();
+  void onConnect(ArEventHandlerFunction cb) {connectHandler = cb;}
+  void send(const char* message, const char* event = nullptr, uint32_t id = 0, uint32_t reconnect = 0);
+  size_t count() const;
+  size_t avgPacketsWaiting() const;
+
+  bool canHandle(AsyncWebServerRequest* request) override;
+  void handleRequest(AsyncWebServerRequest* request) override;
+
+  // host side: a browser opening /events, lastId is its Last-Event-ID header
+  AsyncEventSourceClient* connect(uint32_t lastId = 0);
+  void disconnect(AsyncEventSourceClient* client);
+  const std::vector<std::unique_ptr<AsyncEventSourceClient>>& clients() const {return connected;}
+
+private:
+  String sourceUrl;
+  ArEventHandlerFunction connectHandler;
+  std::vector<std::unique_ptr<AsyncEventSourceClient>> connected;
+};
+
+#endif
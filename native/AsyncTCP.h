@@ -0,0 +1,6 @@
+#ifndef NATIVE_ASYNC_TCP_H
+#define NATIVE_ASYNC_TCP_H
+
+// The host web server stand-in runs handlers synchronously, AsyncTCP itself is not needed.
+
+#endif
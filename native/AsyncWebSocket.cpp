@@ -0,0 +1,101 @@
+#include "AsyncWebSocket.h"
+
+void AsyncWebSocketClient::text(const char* message, size_t len) {
+  if (clientStatus != WS_CONNECTED || queueIsFull()) return;
+  queue.emplace_back();
+  queue.back().concat(message, len);
+}
+
+void AsyncWebSocketClient::binary(const uint8_t* message, size_t len) {
+  text(reinterpret_cast<const char*>(message), len);
+}
+
+std::vector<String> AsyncWebSocketClient::drain() {
+  std::vector<String> messages(queue.begin(), queue.end());
+  queue.clear();
+  return messages;
+}
+
+
+AsyncWebSocket::~AsyncWebSocket() {
+  closeAll();
+}
+
+size_t AsyncWebSocket::count() const {
+  size_t count = 0;
+  for (auto& client : clients) {
+    if (client->status() == WS_CONNECTED) count++;
+  }
+  return count;
+}
+
+AsyncWebSocketClient* AsyncWebSocket::client(uint32_t id) {
+  for (auto& client : clients) {
+    if (client->id() == id && client->status() == WS_CONNECTED) return client.get();
+  }
+  return nullptr;
+}
+
+void AsyncWebSocket::textAll(const char* message, size_t len) {
+  for (auto& client : clients) client->text(message, len);
+}
+
+void AsyncWebSocket::binaryAll(const uint8_t* message, size_t len) {
+  for (auto& client : clients) client->binary(message, len);
+}
+
+void AsyncWebSocket::closeAll() {
+  while (!clients.empty()) disconnect(clients.back().get());
+}
+
+void AsyncWebSocket::cleanupClients(uint16_t maxClients) {
+  while (count() > maxClients) disconnect(clients.front().get());
+}
+
+bool AsyncWebSocket::canHandle(AsyncWebServerRequest* request) {
+  return request->method() == HTTP_GET && request->url() == socketUrl;
+}
+
+void AsyncWebSocket::handleRequest(AsyncWebServerRequest* request) {
+  (void)request;
+  connect();
+}
+
+AsyncWebSocketClient* AsyncWebSocket::connect() {
+  clients.emplace_back(new AsyncWebSocketClient(this, nextId++));
+  AsyncWebSocketClient* client = clients.back().get();
+  if (eventHandler) eventHandler(this, client, WS_EVT_CONNECT, nullptr, nullptr, 0);
+  return client;
+}
+
+void AsyncWebSocket::receive(AsyncWebSocketClient* client, const uint8_t* data, size_t len, AwsFrameType opcode, size_t segmentSize) {
+  if (!eventHandler || client->status() != WS_CONNECTED) return;
+  // one frame, delivered in TCP segments: the handler sees the same frame info with a growing index
+  size_t step = segmentSize == 0 || segmentSize > len ? len : segmentSize;
+  std::vector<uint8_t> segment;
+  AwsFrameInfo info = {};
+  info.message_opcode = opcode;
+  info.opcode = opcode;
+  info.final = 1;
+  info.len = len;
+  size_t index = 0;
+  do {
+    size_t count = std::min(step, len - index);
+    // the library terminates text data in place, keep one spare byte for it
+    segment.assign(data + index, data + index + count);
+    segment.push_back(0);
+    info.index = index;
+    eventHandler(this, client, WS_EVT_DATA, &info, segment.data(), count);
+    index += count;
+  } while (index < len);
+}
+
+void AsyncWebSocket::disconnect(AsyncWebSocketClient* client) {
+  for (auto it = clients.begin(); it != clients.end(); ++it) {
+    if (it->get() != client) continue;
+    if (eventHandler) eventHandler(this, client, WS_EVT_DISCONNECT, nullptr, nullptr, 0);
+    free(client->_tempObject);
+    clients.erase(it);
+    return;
+  }
+}
@@ -0,0 +1,92 @@
+#ifndef NATIVE_ASYNC_WEB_SOCKET_H
+#define NATIVE_ASYNC_WEB_SOCKET_H
+
+// Host stand-in for AsyncWebSocket.
+// Incoming messages are handed to the event handler frame by frame with the same AwsFrameInfo the library fills,
+// outgoing ones wait in the client's queue until the host drains it.
+
+#include <deque>
+#include <functional>
+#include <memory>
+#include <vector>
+#include "ESPAsyncWebServer.h"
+
+#ifndef WS_MAX_QUEUED_MESSAGES
+#define WS_MAX_QUEUED_MESSAGES 32
+#endif
+
+class AsyncWebSocket;
+class AsyncWebSocketClient;
+
+typedef enum {WS_EVT_CONNECT, WS_EVT_DISCONNECT, WS_EVT_PONG, WS_EVT_ERROR, WS_EVT_DATA} AwsEventType;
+typedef enum {WS_CONTINUATION, WS_TEXT, WS_BINARY, WS_DISCONNECT = 0x08, WS_PING, WS_PONG} AwsFrameType;
+typedef enum {WS_DISCONNECTED, WS_CONNECTED, WS_DISCONNECTING} AwsClientStatus;
+
+typedef struct {
+  uint8_t message_opcode;
+  uint32_t num;
+  uint8_t final;
+  uint8_t masked;
+  uint8_t opcode;
+  uint64_t len;
+  uint8_t mask[4];
+  uint64_t index;
+} AwsFrameInfo;
+
+typedef std::function<void(AsyncWebSocket* server, AsyncWebSocketClient* client, AwsEventType type, void* arg, uint8_t* data, size_t len)> AwsEventHandler;
+
+class AsyncWebSocketClient {
+public:
+  AsyncWebSocketClient(AsyncWebSocket* server, uint32_t id) : server(server), clientId(id) {}
+
+  uint32_t id() const {return clientId;}
+  AwsClientStatus status() const {return clientStatus;}
+  void close() {clientStatus = WS_DISCONNECTED;}
+  bool queueIsFull() const {return queue.size() >= WS_MAX_QUEUED_MESSAGES;}
+  void text(const char* message, size_t len);
+  void text(const char* message) {text(message, strlen(message));}
+  void text(const String& message) {text(message.c_str(), message.length());}
+  void binary(const uint8_t* message, size_t len);
+
+  // host side
+  std::vector<String> drain();
+  void* _tempObject = nullptr;
+
+private:
+  AsyncWebSocket* server;
+  uint32_t clientId;
+  AwsClientStatus clientStatus = WS_CONNECTED;
+  std::deque<String> queue;
+};
+
+class AsyncWebSocket : public AsyncWebHandler {
+public:
+  explicit AsyncWebSocket(const String& url) : socketUrl(url) {}
+  ~AsyncWebSocket() override;
+
+  const char* url() const {return socketUrl.c_str();}
+  void onEvent(AwsEventHandler handler) {eventHandler = handler;}
+  size_t count() const;
+  AsyncWebSocketClient* client(uint32_t id);
+  void textAll(const char* message, size_t len);
+  void textAll(const String& message) {textAll(message.c_str(), message.length());}
+  void binaryAll(const uint8_t* message, size_t len);
+  void closeAll();
+  void cleanupClients(uint16_t maxClients = 8);
+
+  bool canHandle(AsyncWebServerRequest* request) override;
+  void handleRequest(AsyncWebServerRequest* request) override;
+
+  // host side: a browser connecting, sending one frame which arrives in segmentSize pieces (0 = one piece) and leaving
+  AsyncWebSocketClient* connect();
+  void receive(AsyncWebSocketClient* client, const uint8_t* data, size_t len, AwsFrameType opcode = WS_TEXT, size_t segmentSize = 0);
+  void disconnect(AsyncWebSocketClient* client);
+
+private:
+  String socketUrl;
+  AwsEventHandler eventHandler;
+  uint32_t nextId = 1;
+  std::vector<std::unique_ptr<AsyncWebSocketClient>> clients;
+};
+
+#endif
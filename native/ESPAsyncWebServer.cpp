@@ -0,0 +1,318 @@
+#include "ESPAsyncWebServer.h"
+
+namespace {
+  String contentTypeFor(const String& path) {
+    if (path.endsWith(".html") || path.endsWith(".htm")) return "text/html";
+    if (path.endsWith(".css")) return "text/css";
+    if (path.endsWith(".js")) return "application/javascript";
+    if (path.endsWith(".json")) return "application/json";
+    if (path.endsWith(".png")) return "image/png";
+    if (path.endsWith(".ico")) return "image/x-icon";
+    if (path.endsWith(".gz")) return "application/x-gzip";
+    return "text/plain";
+  }
+}
+
+AsyncWebServerResponse::AsyncWebServerResponse(int code, const String& contentType)
+  : responseCode(code), type(contentType) {}
+
+void AsyncWebServerResponse::addHeader(const String& name, const String& value) {
+  headers.emplace_back(name, value);
+}
+
+const AsyncWebHeader* AsyncWebServerResponse::getHeader(const String& name) const {
+  for (auto& header : headers) {
+    if (header.name().equalsIgnoreCase(name)) return &header;
+  }
+  return nullptr;
+}
+
+String AsyncWebServerResponse::drain(size_t segmentSize, uint32_t* segments) {
+  String body;
+  std::vector<uint8_t> buffer(segmentSize);
+  uint32_t count = 0;
+  uint32_t retries = 0;
+  size_t index = 0;
+  while (chunked || index < length) {
+    size_t maxLen = chunked ? segmentSize : std::min(segmentSize, length - index);
+    size_t written = fill(buffer.data(), maxLen, index);
+    if (written == RESPONSE_TRY_AGAIN) {
+      if (++retries > 1000) break;
+      yield();
+      continue;
+    }
+    if (written == 0) break;
+    body.concat(reinterpret_cast<const char*>(buffer.data()), written);
+    index += written;
+    count++;
+  }
+  if (segments) *segments = count;
+  return body;
+}
+
+
+AsyncBasicResponse::AsyncBasicResponse(int code, const String& contentType, const String& content)
+  : AsyncWebServerResponse(code, contentType), content(content) {
+  length = content.length();
+}
+
+size_t AsyncBasicResponse::fill(uint8_t* buffer, size_t maxLen, size_t index) {
+  if (index >= content.length()) return 0;
+  size_t count = std::min(maxLen, content.length() - index);
+  memcpy(buffer, content.c_str() + index, count);
+  return count;
+}
+
+
+AsyncFileResponse::AsyncFileResponse(FS& fs, const String& path, const String& contentType, bool download)
+  : AsyncWebServerResponse(200, contentType.isEmpty() ? contentTypeFor(path) : contentType) {
+  String filePath(path);
+  if (!download && !fs.exists(filePath) && fs.exists(filePath + ".gz")) {
+    filePath += ".gz";
+    addHeader("Content-Encoding", "gzip");
+  }
+  file = fs.open(filePath, "r");
+  if (file) length = file.size();
+  else responseCode = 404;
+}
+
+size_t AsyncFileResponse::fill(uint8_t* buffer, size_t maxLen, size_t index) {
+  (void)index;
+  return file.read(buffer, maxLen);
+}
+
+
+AsyncCallbackResponse::AsyncCallbackResponse(const String& contentType, size_t len, AwsResponseFiller callback)
+  : AsyncWebServerResponse(200, contentType), callback(callback) {
+  length = len;
+}
+
+size_t AsyncCallbackResponse::fill(uint8_t* buffer, size_t maxLen, size_t index) {
+  return callback(buffer, maxLen, index);
+}
+
+AsyncChunkedResponse::AsyncChunkedResponse(const String& contentType, AwsResponseFiller callback)
+  : AsyncCallbackResponse(contentType, 0, callback) {
+  chunked = true;
+}
+
+
+AsyncResponseStream::AsyncResponseStream(const String& contentType, size_t bufferSize)
+  : AsyncWebServerResponse(200, contentType) {
+  content.reserve(bufferSize);
+}
+
+size_t AsyncResponseStream::write(uint8_t c) {
+  return write(&c, 1);
+}
+
+size_t AsyncResponseStream::write(const uint8_t* data, size_t len) {
+  content.concat(reinterpret_cast<const char*>(data), len);
+  length = content.length();
+  return len;
+}
+
+size_t AsyncResponseStream::fill(uint8_t* buffer, size_t maxLen, size_t index) {
+  if (index >= content.length()) return 0;
+  size_t count = std::min(maxLen, content.length() - index);
+  memcpy(buffer, content.c_str() + index, count);
+  return count;
+}
+
+
+AsyncWebServerRequest::AsyncWebServerRequest(WebRequestMethodComposite method, const String& url)
+  : requestMethod(method) {
+  int query = url.indexOf('?');
+  requestUrl = query < 0 ? url : url.substring(0, query);
+  if (query < 0) return;
+  String params = url.substring(query + 1);
+  size_t start = 0;
+  while (start < params.length()) {
+    int end = params.indexOf('&', start);
+    String pair = params.substring(start, end < 0 ? params.length() : end);
+    int eq = pair.indexOf('=');
+    if (eq < 0) addParam(pair, String());
+    else addParam(pair.substring(0, eq), pair.substring(eq + 1));
+    if (end < 0) break;
+    start = end + 1;
+  }
+}
+
+AsyncWebServerRequest::~AsyncWebServerRequest() {
+  if (disconnectHandler) disconnectHandler();
+  free(_tempObject);
+}
+
+bool AsyncWebServerRequest::hasParam(const String& name, bool post, bool file) const {
+  return getParam(name, post, file) != nullptr;
+}
+
+AsyncWebParameter* AsyncWebServerRequest::getParam(const String& name, bool post, bool file) const {
+  (void)file;
+  for (auto& param : parameters) {
+    if (param->name() == name && param->isPost() == post) return param.get();
+  }
+  return nullptr;
+}
+
+AsyncWebParameter* AsyncWebServerRequest::getParam(size_t index) const {
+  return index < parameters.size() ? parameters[index].get() : nullptr;
+}
+
+void AsyncWebServerRequest::addParam(const String& name, const String& value, bool post) {
+  parameters.emplace_back(new AsyncWebParameter(name, value, post));
+}
+
+bool AsyncWebServerRequest::hasHeader(const String& name) const {
+  return getHeader(name) != nullptr;
+}
+
+AsyncWebHeader* AsyncWebServerRequest::getHeader(const String& name) const {
+  for (auto& header : requestHeaders) {
+    if (header->name().equalsIgnoreCase(name)) return header.get();
+  }
+  return nullptr;
+}
+
+String AsyncWebServerRequest::header(const char* name) const {
+  AsyncWebHeader* found = getHeader(name);
+  return found ? found->value() : String();
+}
+
+void AsyncWebServerRequest::addHeader(const String& name, const String& value) {
+  requestHeaders.emplace_back(new AsyncWebHeader(name, value));
+}
+
+void AsyncWebServerRequest::send(int code, const String& contentType, const String& content) {
+  send(beginResponse(code, contentType, content));
+}
+
+void AsyncWebServerRequest::send(AsyncWebServerResponse* response) {
+  // like the device, only the first response of a request goes out
+  if (sentResponse) delete response;
+  else sentResponse.reset(response);
+}
+
+void AsyncWebServerRequest::send(FS& fs, const String& path, const String& contentType, bool download) {
+  auto response = new AsyncFileResponse(fs, path, contentType, download);
+  if (response->found()) send(response);
+  else {
+    delete response;
+    send(404);
+  }
+}
+
+AsyncWebServerResponse* AsyncWebServerRequest::beginResponse(int code, const String& contentType, const String& content) {
+  return new AsyncBasicResponse(code, contentType, content);
+}
+
+AsyncWebServerResponse* AsyncWebServerRequest::beginResponse(FS& fs, const String& path, const String& contentType, bool download) {
+  return new AsyncFileResponse(fs, path, contentType, download);
+}
+
+AsyncWebServerResponse* AsyncWebServerRequest::beginResponse(const String& contentType, size_t len, AwsResponseFiller callback) {
+  return new AsyncCallbackResponse(contentType, len, callback);
+}
+
+AsyncWebServerResponse* AsyncWebServerRequest::beginChunkedResponse(const String& contentType, AwsResponseFiller callback) {
+  return new AsyncChunkedResponse(contentType, callback);
+}
+
+AsyncResponseStream* AsyncWebServerRequest::beginResponseStream(const String& contentType, size_t bufferSize) {
+  return new AsyncResponseStream(contentType, bufferSize);
+}
+
+
+bool AsyncCallbackWebHandler::canHandle(AsyncWebServerRequest* request) {
+  if (!requestHandler) return false;
+  if (!(method & request->method())) return false;
+  if (uri.length() && uri.endsWith("*")) {
+    return request->url().startsWith(uri.substring(0, uri.length() - 1));
+  }
+  return uri.length() == 0 || request->url() == uri || request->url().startsWith(uri + "/");
+}
+
+void AsyncCallbackWebHandler::handleRequest(AsyncWebServerRequest* request) {
+  if (requestHandler) requestHandler(request);
+  else request->send(500);
+}
+
+void AsyncCallbackWebHandler::handleBody(AsyncWebServerRequest* request, uint8_t* data, size_t len, size_t index, size_t total) {
+  if (bodyHandler) bodyHandler(request, data, len, index, total);
+}
+
+
+AsyncWebServer::~AsyncWebServer() {
+  reset();
+}
+
+AsyncCallbackWebHandler& AsyncWebServer::on(const char* uri, WebRequestMethodComposite method, ArRequestHandlerFunction onRequest) {
+  return on(uri, method, onRequest, nullptr, nullptr);
+}
+
+AsyncCallbackWebHandler& AsyncWebServer::on(const char* uri, WebRequestMethodComposite method, ArRequestHandlerFunction onRequest,
+                                            ArUploadHandlerFunction onUpload, ArBodyHandlerFunction onBody) {
+  auto handler = new AsyncCallbackWebHandler(uri, method);
+  handler->onRequest(onRequest);
+  handler->onUpload(onUpload);
+  handler->onBody(onBody);
+  ownedHandlers.push_back(handler);
+  handlers.push_back(handler);
+  return *handler;
+}
+
+AsyncWebHandler& AsyncWebServer::addHandler(AsyncWebHandler* handler) {
+  handlers.push_back(handler);
+  return *handler;
+}
+
+bool AsyncWebServer::removeHandler(AsyncWebHandler* handler) {
+  for (auto it = handlers.begin(); it != handlers.end(); ++it) {
+    if (*it == handler) {
+      handlers.erase(it);
+      return true;
+    }
+  }
+  return false;
+}
+
+void AsyncWebServer::reset() {
+  for (auto handler : ownedHandlers) delete handler;
+  ownedHandlers.clear();
+  handlers.clear();
+  notFoundHandler = nullptr;
+}
+
+AsyncWebHandler* AsyncWebServer::handlerFor(AsyncWebServerRequest& request) {
+  for (auto handler : handlers) {
+    if (handler->canHandle(&request)) return handler;
+  }
+  return nullptr;
+}
+
+void AsyncWebServer::handleBody(AsyncWebServerRequest& request, const uint8_t* data, size_t len, size_t index, size_t total) {
+  AsyncWebHandler* target = handlerFor(request);
+  if (target == nullptr) return;
+  std::vector<uint8_t> segment(data, data + len);
+  target->handleBody(&request, segment.data(), len, index, total);
+}
+
+void AsyncWebServer::handle(AsyncWebServerRequest& request, const uint8_t* body, size_t bodyLength, size_t bodySegment) {
+  AsyncWebHandler* target = handlerFor(request);
+  if (target == nullptr) {
+    if (notFoundHandler) notFoundHandler(&request);
+    else request.send(404);
+    return;
+  }
+  if (body != nullptr && bodyLength > 0) {
+    // the device hands out body pieces from its own receive buffer, copy so handlers may not rely on the caller's memory
+    std::vector<uint8_t> segment;
+    size_t step = bodySegment == 0 ? bodyLength : bodySegment;
+    for (size_t index = 0; index < bodyLength; index += step) {
+      size_t len = std::min(step, bodyLength - index);
+      segment.assign(body + index, body + index + len);
+      target->handleBody(&request, segment.data(), len, index, bodyLength);
+    }
+  }
+  target->handleRequest(&request);
+}
@@ -0,0 +1,240 @@
+#ifndef NATIVE_ESP_ASYNC_WEB_SERVER_H
+#define NATIVE_ESP_ASYNC_WEB_SERVER_H
+
+// Host stand-in for ESPAsyncWebServer.
+// Handlers run synchronously from AsyncWebServer::handle(), responses are drained segment by segment
+// the way AsyncTCP would do it, so chunked fillers and body handlers see the same call pattern as on the device.
+
+#include <functional>
+#include <memory>
+#include <vector>
+#include "Arduino.h"
+#include "FS.h"
+
+#define RESPONSE_TRY_AGAIN 0xFFFFFFFF
+
+typedef enum {
+  HTTP_GET     = 0b00000001,
+  HTTP_POST    = 0b00000010,
+  HTTP_DELETE  = 0b00000100,
+  HTTP_PUT     = 0b00001000,
+  HTTP_PATCH   = 0b00010000,
+  HTTP_HEAD    = 0b00100000,
+  HTTP_OPTIONS = 0b01000000,
+  HTTP_ANY     = 0b01111111,
+} WebRequestMethod;
+typedef uint8_t WebRequestMethodComposite;
+
+class AsyncWebServerRequest;
+class AsyncWebServerResponse;
+class AsyncResponseStream;
+
+typedef std::function<void(AsyncWebServerRequest* request)> ArRequestHandlerFunction;
+typedef std::function<void(AsyncWebServerRequest* request, const String& filename, size_t index, uint8_t* data, size_t len, bool final)> ArUploadHandlerFunction;
+typedef std::function<void(AsyncWebServerRequest* request, uint8_t* data, size_t len, size_t index, size_t total)> ArBodyHandlerFunction;
+typedef std::function<size_t(uint8_t* buffer, size_t maxLen, size_t index)> AwsResponseFiller;
+typedef std::function<void(void)> ArDisconnectHandler;
+
+class AsyncWebHeader {
+public:
+  AsyncWebHeader(const String& name, const String& value) : headerName(name), headerValue(value) {}
+  const String& name() const {return headerName;}
+  const String& value() const {return headerValue;}
+private:
+  String headerName;
+  String headerValue;
+};
+
+class AsyncWebParameter {
+public:
+  AsyncWebParameter(const String& name, const String& value, bool form = false)
+    : paramName(name), paramValue(value), form(form) {}
+  const String& name() const {return paramName;}
+  const String& value() const {return paramValue;}
+  bool isPost() const {return form;}
+  bool isFile() const {return false;}
+private:
+  String paramName;
+  String paramValue;
+  bool form;
+};
+
+
+class AsyncWebServerResponse {
+public:
+  AsyncWebServerResponse(int code, const String& contentType);
+  virtual ~AsyncWebServerResponse() = default;
+
+  void setCode(int code) {this->responseCode = code;}
+  void setContentLength(size_t len) {this->length = len;}
+  void setContentType(const String& type) {this->type = type;}
+  void addHeader(const String& name, const String& value);
+  bool isChunked() const {return chunked;}
+
+  // host side inspection
+  int code() const {return responseCode;}
+  const String& contentType() const {return type;}
+  const AsyncWebHeader* getHeader(const String& name) const;
+  size_t headerCount() const {return headers.size();}
+  // Produces the body the way AsyncTCP pulls it: at most segmentSize bytes per fill() call.
+  String drain(size_t segmentSize = 1436, uint32_t* segments = nullptr);
+  virtual size_t fill(uint8_t* buffer, size_t maxLen, size_t index) = 0;
+
+protected:
+  int responseCode;
+  String type;
+  size_t length = 0;
+  bool chunked = false;
+  std::vector<AsyncWebHeader> headers;
+};
+
+class AsyncBasicResponse : public AsyncWebServerResponse {
+public:
+  AsyncBasicResponse(int code, const String& contentType = String(), const String& content = String());
+  size_t fill(uint8_t* buffer, size_t maxLen, size_t index) override;
+private:
+  String content;
+};
+
+class AsyncFileResponse : public AsyncWebServerResponse {
+public:
+  AsyncFileResponse(FS& fs, const String& path, const String& contentType = String(), bool download = false);
+  size_t fill(uint8_t* buffer, size_t maxLen, size_t index) override;
+  bool found() const {return static_cast<bool>(file);}
+private:
+  File file;
+};
+
+class AsyncCallbackResponse : public AsyncWebServerResponse {
+public:
+  AsyncCallbackResponse(const String& contentType, size_t len, AwsResponseFiller callback);
+  size_t fill(uint8_t* buffer, size_t maxLen, size_t index) override;
+protected:
+  AwsResponseFiller callback;
+};
+
+class AsyncChunkedResponse : public AsyncCallbackResponse {
+public:
+  AsyncChunkedResponse(const String& contentType, AwsResponseFiller callback);
+};
+
+class AsyncResponseStream : public AsyncWebServerResponse, public Print {
+public:
+  AsyncResponseStream(const String& contentType, size_t bufferSize);
+  size_t write(uint8_t c) override;
+  size_t write(const uint8_t* data, size_t len) override;
+  using Print::write;
+  size_t fill(uint8_t* buffer, size_t maxLen, size_t index) override;
+private:
+  String content;
+};
+
+
+class AsyncWebServerRequest {
+public:
+  AsyncWebServerRequest(WebRequestMethodComposite method, const String& url);
+  ~AsyncWebServerRequest();
+
+  WebRequestMethodComposite method() const {return requestMethod;}
+  const String& url() const {return requestUrl;}
+
+  size_t params() const {return parameters.size();}
+  bool hasParam(const String& name, bool post = false, bool file = false) const;
+  AsyncWebParameter* getParam(const String& name, bool post = false, bool file = false) const;
+  AsyncWebParameter* getParam(size_t index) const;
+  void addParam(const String& name, const String& value, bool post = false);
+
+  size_t headers() const {return requestHeaders.size();}
+  bool hasHeader(const String& name) const;
+  AsyncWebHeader* getHeader(const String& name) const;
+  String header(const char* name) const;
+  void addHeader(const String& name, const String& value);
+
+  void send(int code, const String& contentType = String(), const String& content = String());
+  void send(AsyncWebServerResponse* response);
+  void send(FS& fs, const String& path, const String& contentType = String(), bool download = false);
+  AsyncWebServerResponse* beginResponse(int code, const String& contentType = String(), const String& content = String());
+  AsyncWebServerResponse* beginResponse(FS& fs, const String& path, const String& contentType = String(), bool download = false);
+  AsyncWebServerResponse* beginResponse(const String& contentType, size_t len, AwsResponseFiller callback);
+  AsyncWebServerResponse* beginChunkedResponse(const String& contentType, AwsResponseFiller callback);
+  AsyncResponseStream* beginResponseStream(const String& contentType, size_t bufferSize = 1460);
+
+  void onDisconnect(ArDisconnectHandler fn) {disconnectHandler = fn;}
+  void* _tempObject = nullptr;
+
+  // host side inspection
+  AsyncWebServerResponse* response() const {return sentResponse.get();}
+
+private:
+  WebRequestMethodComposite requestMethod;
+  String requestUrl;
+  std::vector<std::unique_ptr<AsyncWebParameter>> parameters;
+  std::vector<std::unique_ptr<AsyncWebHeader>> requestHeaders;
+  std::unique_ptr<AsyncWebServerResponse> sentResponse;
+  ArDisconnectHandler disconnectHandler;
+};
+
+
+class AsyncWebHandler {
+public:
+  virtual ~AsyncWebHandler() = default;
+  virtual bool canHandle(AsyncWebServerRequest* request) {(void)request; return false;}
+  virtual void handleRequest(AsyncWebServerRequest* request) {(void)request;}
+  virtual void handleBody(AsyncWebServerRequest* request, uint8_t* data, size_t len, size_t index, size_t total) {
+    (void)request; (void)data; (void)len; (void)index; (void)total;
+  }
+};
+
+class AsyncCallbackWebHandler : public AsyncWebHandler {
+public:
+  AsyncCallbackWebHandler(const String& uri, WebRequestMethodComposite method) : uri(uri), method(method) {}
+  void onRequest(ArRequestHandlerFunction fn) {requestHandler = fn;}
+  void onUpload(ArUploadHandlerFunction fn) {uploadHandler = fn;}
+  void onBody(ArBodyHandlerFunction fn) {bodyHandler = fn;}
+  bool canHandle(AsyncWebServerRequest* request) override;
+  void handleRequest(AsyncWebServerRequest* request) override;
+  void handleBody(AsyncWebServerRequest* request, uint8_t* data, size_t len, size_t index, size_t total) override;
+private:
+  String uri;
+  WebRequestMethodComposite method;
+  ArRequestHandlerFunction requestHandler;
+  ArUploadHandlerFunction uploadHandler;
+  ArBodyHandlerFunction bodyHandler;
+};
+
+
+class AsyncWebServer {
+public:
+  explicit AsyncWebServer(uint16_t port) : port(port) {}
+  ~AsyncWebServer();
+
+  AsyncCallbackWebHandler& on(const char* uri, WebRequestMethodComposite method, ArRequestHandlerFunction onRequest);
+  AsyncCallbackWebHandler& on(const char* uri, WebRequestMethodComposite method, ArRequestHandlerFunction onRequest,
+                              ArUploadHandlerFunction onUpload, ArBodyHandlerFunction onBody = nullptr);
+  AsyncWebHandler& addHandler(AsyncWebHandler* handler);
+  bool removeHandler(AsyncWebHandler* handler);
+  void onNotFound(ArRequestHandlerFunction fn) {notFoundHandler = fn;}
+  void begin() {}
+  void end() {}
+  void reset();
+
+  // host side: runs the request through the registered handlers,
+  // the body is delivered in bodySegment sized pieces like TCP segments would arrive.
+  void handle(AsyncWebServerRequest& request, const uint8_t* body = nullptr, size_t bodyLength = 0, size_t bodySegment = 0);
+  // host side: one body segment, so segments of several requests can interleave like concurrent connections,
+  // handle() without a body then completes the request.
+  void handleBody(AsyncWebServerRequest& request, const uint8_t* data, size_t len, size_t index, size_t total);
+
+private:
+  AsyncWebHandler* handlerFor(AsyncWebServerRequest& request);
+
+  uint16_t port;
+  std::vector<AsyncWebHandler*> handlers;
+  std::vector<AsyncCallbackWebHandler*> ownedHandlers;
+  ArRequestHandlerFunction notFoundHandler;
+};
+
+#include "AsyncEventSource.h"
+#include "AsyncWebSocket.h"
+
+#endif
@@ -0,0 +1,19 @@
+#ifndef NATIVE_ESP_H
+#define NATIVE_ESP_H
+
+#include <cstdint>
+#include "NativeHeap.h"
+
+class EspClass {
+public:
+  uint32_t getHeapSize() {return static_cast<uint32_t>(NativeHeap::capacity());}
+  uint32_t getFreeHeap() {return static_cast<uint32_t>(NativeHeap::freeBytes());}
+  uint32_t getMinFreeHeap() {return static_cast<uint32_t>(NativeHeap::capacity() - NativeHeap::peak());}
+  uint32_t getMaxAllocHeap() {return static_cast<uint32_t>(NativeHeap::largestFreeBlock());}
+  uint8_t getHeapFragmentation() {return NativeHeap::fragmentation();}
+  void restart() {}
+};
+
+extern EspClass ESP;
+
+#endif
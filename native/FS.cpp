@@ -0,0 +1,115 @@
+#include "FS.h"
+
+#include <cstdlib>
+#include <sys/stat.h>
+
+namespace fs {
+
+  File::File(FILE* file, const String& path, std::shared_ptr<uint8_t> openFiles)
+    : handle(file, [openFiles](FILE* f) {
+        fclose(f);
+        if (openFiles) --*openFiles;
+      }), path(path) {
+    if (openFiles) ++*openFiles;
+  }
+
+  size_t File::write(uint8_t c) {
+    return write(&c, 1);
+  }
+
+  size_t File::write(const uint8_t* buffer, size_t size) {
+    if (!handle) return 0;
+    return fwrite(buffer, 1, size, handle.get());
+  }
+
+  int File::available() {
+    if (!handle) return 0;
+    return static_cast<int>(size() - position());
+  }
+
+  int File::read() {
+    if (!handle) return -1;
+    int c = fgetc(handle.get());
+    return c == EOF ? -1 : c;
+  }
+
+  int File::peek() {
+    if (!handle) return -1;
+    int c = fgetc(handle.get());
+    if (c == EOF) return -1;
+    ungetc(c, handle.get());
+    return c;
+  }
+
+  size_t File::read(uint8_t* buffer, size_t size) {
+    if (!handle) return 0;
+    return fread(buffer, 1, size, handle.get());
+  }
+
+  bool File::seek(uint32_t position, SeekMode mode) {
+    if (!handle) return false;
+    int whence = mode == SeekSet ? SEEK_SET : (mode == SeekCur ? SEEK_CUR : SEEK_END);
+    return fseek(handle.get(), static_cast<long>(position), whence) == 0;
+  }
+
+  size_t File::position() const {
+    if (!handle) return 0;
+    long pos = ftell(handle.get());
+    return pos < 0 ? 0 : static_cast<size_t>(pos);
+  }
+
+  size_t File::size() const {
+    if (!handle) return 0;
+    long current = ftell(handle.get());
+    fseek(handle.get(), 0, SEEK_END);
+    long end = ftell(handle.get());
+    fseek(handle.get(), current, SEEK_SET);
+    return end < 0 ? 0 : static_cast<size_t>(end);
+  }
+
+  void File::flush() {
+    if (handle) fflush(handle.get());
+  }
+
+  void File::close() {
+    handle.reset();
+  }
+
+
+  bool FS::begin(bool, const char*, uint8_t maxOpenFiles) {
+    maxOpen = maxOpenFiles;
+    if (root.isEmpty()) {
+      const char* dir = getenv("NATIVE_SPIFFS_DIR");
+      root = dir ? dir : "data";
+    }
+    mkdir(root.c_str(), 0755);
+    return true;
+  }
+
+  String FS::hostPath(const char* path) const {
+    String result(root.isEmpty() ? "data" : root.c_str());
+    if (path[0] != '/') result += '/';
+    result += path;
+    return result;
+  }
+
+  File FS::open(const char* path, const char* mode) {
+    if (*live >= maxOpen) return File();
+    opens++;
+    String host = hostPath(path);
+    String hostMode(mode);
+    if (!hostMode.endsWith("b")) hostMode += 'b';
+    FILE* file = fopen(host.c_str(), hostMode.c_str());
+    if (file == nullptr) return File();
+    return File(file, String(path), live);
+  }
+
+  bool FS::exists(const char* path) {
+    struct stat info;
+    return stat(hostPath(path).c_str(), &info) == 0;
+  }
+
+  bool FS::remove(const char* path) {
+    return ::remove(hostPath(path).c_str()) == 0;
+  }
+}
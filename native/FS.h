@@ -0,0 +1,82 @@
+#ifndef NATIVE_FS_H
+#define NATIVE_FS_H
+
+#include <cstdio>
+#include <memory>
+#include "Arduino.h"
+
+#define FILE_READ "r"
+#define FILE_WRITE "w"
+#define FILE_APPEND "a"
+
+namespace fs {
+
+  enum SeekMode {
+    SeekSet = 0,
+    SeekCur = 1,
+    SeekEnd = 2
+  };
+
+  // Host file handle, copies share the same underlying FILE like the Arduino File does.
+  class File : public Stream {
+  public:
+    File() = default;
+    File(FILE* file, const String& path, std::shared_ptr<uint8_t> openFiles = nullptr);
+
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t* buffer, size_t size) override;
+    using Print::write;
+    int available() override;
+    int read() override;
+    int peek() override;
+    size_t read(uint8_t* buffer, size_t size);
+    size_t readBytes(char* buffer, size_t length) override {return read(reinterpret_cast<uint8_t*>(buffer), length);}
+    using Stream::readBytes;
+    bool seek(uint32_t position, SeekMode mode = SeekSet);
+    size_t position() const;
+    size_t size() const;
+    void flush() override;
+    void close();
+    const char* name() const {return path.c_str();}
+    const char* path_c() const {return path.c_str();}
+    bool isDirectory() const {return false;}
+    explicit operator bool() const {return static_cast<bool>(handle);}
+
+  private:
+    std::shared_ptr<FILE> handle;
+    String path;
+  };
+
+  // Maps device paths ("/index.html") onto a host directory, NATIVE_SPIFFS_DIR or ./data by default.
+  class FS {
+  public:
+    bool begin(bool formatOnFail = false, const char* basePath = "/spiffs", uint8_t maxOpenFiles = 10);
+    void end() {}
+    File open(const char* path, const char* mode = FILE_READ);
+    File open(const String& path, const char* mode = FILE_READ) {return open(path.c_str(), mode);}
+    bool exists(const char* path);
+    bool exists(const String& path) {return exists(path.c_str());}
+    bool remove(const char* path);
+    bool remove(const String& path) {return remove(path.c_str());}
+    String hostPath(const char* path) const;
+    void setRoot(const char* root) {this->root = root;}
+    // like the ESP32 VFS, an open beyond maxOpenFiles handles fails
+    uint32_t openCount() const {return opens;}
+    uint8_t openFiles() const {return *live;}
+
+  private:
+    String root;
+    uint8_t maxOpen = 10;
+    uint32_t opens = 0;
+    std::shared_ptr<uint8_t> live = std::make_shared<uint8_t>(0);
+  };
+}
+
+using fs::File;
+using fs::FS;
+using fs::SeekMode;
+using fs::SeekSet;
+using fs::SeekCur;
+using fs::SeekEnd;
+
+#endif
@@ -0,0 +1,63 @@
+#include "HardwareSerial.h"
+#include "Arduino.h"
+
+#include <cstdio>
+#include <cstdlib>
+
+HardwareSerial Serial;
+
+void HardwareSerial::begin(unsigned long baud) {
+  this->baud = baud;
+  this->echo = getenv("NATIVE_SERIAL_ECHO") != nullptr;
+}
+
+void HardwareSerial::setTxFifo(size_t size) {
+  fifoSize = size;
+  fifoUsed = 0;
+  drainedAt = micros();
+}
+
+void HardwareSerial::drainFifo() {
+  uint32_t now = micros();
+  uint64_t bytes = static_cast<uint64_t>(now - drainedAt) * baud / 10000000;
+  if (bytes >= fifoUsed) {
+    fifoUsed = 0;
+    drainedAt = now;
+  } else {
+    fifoUsed -= bytes;
+    drainedAt += static_cast<uint32_t>(bytes * 10000000 / baud);   // keeps the part of a byte already on the wire
+  }
+}
+
+int HardwareSerial::availableForWrite() {
+  if (fifoSize == 0) return 0x7FFF;
+  drainFifo();
+  return static_cast<int>(fifoSize - fifoUsed);
+}
+
+size_t HardwareSerial::write(uint8_t c) {
+  return write(&c, 1);
+}
+
+size_t HardwareSerial::write(const uint8_t* buffer, size_t size) {
+  for (size_t done = 0; fifoSize > 0 && done < size;) {
+    drainFifo();
+    size_t count = std::min(size - done, fifoSize - fifoUsed);
+    if (count == 0) {
+      // until one byte left the FIFO
+      uint32_t wait = static_cast<uint32_t>(10000000 / baud + 1 - (micros() - drainedAt));
+      blockedUs += wait;
+      delayMicroseconds(wait);
+      continue;
+    }
+    fifoUsed += count;
+    done += count;
+  }
+  written += size;
+  for (size_t i = 0; i < size; i++) {
+    if (buffer[i] == '\n') lines++;
+  }
+  if (tap) tap->write(buffer, size);
+  if (echo) fwrite(buffer, 1, size, stderr);
+  return size;
+}
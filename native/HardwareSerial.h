@@ -0,0 +1,48 @@
+#ifndef NATIVE_HARDWARE_SERIAL_H
+#define NATIVE_HARDWARE_SERIAL_H
+
+#include "Stream.h"
+
+// Host UART: output is counted and only echoed to stderr when NATIVE_SERIAL_ECHO is set in the environment.
+// With setTxFifo() it models the link: a TX FIFO drained at the baud rate (8N1, ten bits per byte) on the Arduino clock,
+// and a write which does not fit waits for it like the device does. Without, writes never wait.
+class HardwareSerial : public Stream {
+public:
+  void begin(unsigned long baud);
+  void end() {}
+  unsigned long baudRate() const {return baud;}
+  void setTxFifo(size_t size);                                  // 0 turns the model off
+
+  size_t write(uint8_t c) override;
+  size_t write(const uint8_t* buffer, size_t size) override;
+  using Print::write;
+  int availableForWrite() override;
+
+  int available() override {return 0;}
+  int read() override {return -1;}
+  int peek() override {return -1;}
+
+  uint64_t bytesWritten() const {return written;}
+  uint64_t linesWritten() const {return lines;}
+  uint64_t blockedMicros() const {return blockedUs;}           // writers waited for the FIFO
+  void setTap(Print* tap) {this->tap = tap;}                    // gets a copy of every byte written
+  void resetCounters() {written = lines = blockedUs = 0;}
+  explicit operator bool() const {return true;}
+
+private:
+  void drainFifo();
+
+  unsigned long baud = 0;
+  uint64_t written = 0;
+  uint64_t lines = 0;
+  uint64_t blockedUs = 0;
+  size_t fifoSize = 0;
+  size_t fifoUsed = 0;
+  uint32_t drainedAt = 0;                                       // micros() the FIFO was drained up to
+  Print* tap = nullptr;
+  bool echo = false;
+};
+
+extern HardwareSerial Serial;
+
+#endif
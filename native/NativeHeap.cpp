@@ -0,0 +1,229 @@
+#include "NativeHeap.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#ifndef NATIVE_HEAP_ARENA_SIZE
+#define NATIVE_HEAP_ARENA_SIZE (256u * 1024u * 1024u)
+#endif
+
+extern "C" {
+  void* __real_malloc(size_t size);
+  void __real_free(void* ptr);
+  void* __real_realloc(void* ptr, size_t size);
+  void* __real_calloc(size_t count, size_t size);
+}
+
+namespace {
+  struct Block {
+    size_t size;       // whole block including this header
+    Block* next;       // next free block (address ordered), only valid while free
+  };
+
+  const size_t HeaderSize = sizeof(Block);
+  const size_t Alignment = 16;
+  const size_t MinBlockSize = 2 * HeaderSize;
+
+  alignas(16) uint8_t arena[NATIVE_HEAP_ARENA_SIZE];
+  Block* freeList = nullptr;
+  size_t arenaEnd = NATIVE_HEAP_ARENA_SIZE;
+  size_t usedBytes = 0;
+  size_t peakBytes = 0;
+  uint32_t allocationCount = 0;
+  bool initialized = false;
+  std::atomic_flag heapLock = ATOMIC_FLAG_INIT;
+
+  class HeapGuard {
+  public:
+    HeapGuard() {while (heapLock.test_and_set(std::memory_order_acquire)) {}}
+    ~HeapGuard() {heapLock.clear(std::memory_order_release);}
+  };
+
+  void initialize() {
+    if (initialized) return;
+    freeList = reinterpret_cast<Block*>(arena);
+    freeList->size = arenaEnd;
+    freeList->next = nullptr;
+    initialized = true;
+  }
+
+  bool owns(const void* ptr) {
+    auto p = static_cast<const uint8_t*>(ptr);
+    return p >= arena && p < arena + NATIVE_HEAP_ARENA_SIZE;
+  }
+
+  size_t blockSizeFor(size_t size) {
+    size_t total = (size + HeaderSize + Alignment - 1) & ~(Alignment - 1);
+    return total < MinBlockSize ? MinBlockSize : total;
+  }
+
+  void* allocate(size_t size) {
+    initialize();
+    size_t needed = blockSizeFor(size);
+    Block* prev = nullptr;
+    for (Block* block = freeList; block != nullptr; prev = block, block = block->next) {
+      if (block->size < needed) continue;
+      Block* next = block->next;
+      if (block->size - needed >= MinBlockSize) {
+        auto rest = reinterpret_cast<Block*>(reinterpret_cast<uint8_t*>(block) + needed);
+        rest->size = block->size - needed;
+        rest->next = next;
+        next = rest;
+        block->size = needed;
+      }
+      if (prev) prev->next = next;
+      else freeList = next;
+      block->next = nullptr;
+      usedBytes += block->size;
+      if (usedBytes > peakBytes) peakBytes = usedBytes;
+      allocationCount++;
+      return reinterpret_cast<uint8_t*>(block) + HeaderSize;
+    }
+    return nullptr;
+  }
+
+  void release(void* ptr) {
+    auto block = reinterpret_cast<Block*>(static_cast<uint8_t*>(ptr) - HeaderSize);
+    usedBytes -= block->size;
+    Block* prev = nullptr;
+    Block* next = freeList;
+    while (next != nullptr && next < block) {
+      prev = next;
+      next = next->next;
+    }
+    block->next = next;
+    if (next && reinterpret_cast<uint8_t*>(block) + block->size == reinterpret_cast<uint8_t*>(next)) {
+      block->size += next->size;
+      block->next = next->next;
+    }
+    if (prev) {
+      prev->next = block;
+      if (reinterpret_cast<uint8_t*>(prev) + prev->size == reinterpret_cast<uint8_t*>(block)) {
+        prev->size += block->size;
+        prev->next = block->next;
+      }
+    } else freeList = block;
+  }
+
+  size_t payloadSize(const void* ptr) {
+    auto block = reinterpret_cast<const Block*>(static_cast<const uint8_t*>(ptr) - HeaderSize);
+    return block->size - HeaderSize;
+  }
+}
+
+extern "C" {
+  void* __wrap_malloc(size_t size) {
+    HeapGuard guard;
+    return allocate(size);
+  }
+
+  void __wrap_free(void* ptr) {
+    if (ptr == nullptr) return;
+    if (!owns(ptr)) {
+      __real_free(ptr);
+      return;
+    }
+    HeapGuard guard;
+    release(ptr);
+  }
+
+  void* __wrap_calloc(size_t count, size_t size) {
+    void* ptr = __wrap_malloc(count * size);
+    if (ptr) memset(ptr, 0, count * size);
+    return ptr;
+  }
+
+  void* __wrap_realloc(void* ptr, size_t size) {
+    if (ptr == nullptr) return __wrap_malloc(size);
+    if (!owns(ptr)) return __real_realloc(ptr, size);
+    if (size == 0) {
+      __wrap_free(ptr);
+      return nullptr;
+    }
+    size_t oldSize = payloadSize(ptr);
+    if (oldSize >= size) return ptr;
+    void* newPtr = __wrap_malloc(size);
+    if (newPtr == nullptr) return nullptr;
+    memcpy(newPtr, ptr, oldSize);
+    __wrap_free(ptr);
+    return newPtr;
+  }
+}
+
+void* operator new(size_t size) {
+  void* ptr = malloc(size);
+  if (ptr == nullptr) throw std::bad_alloc();
+  return ptr;
+}
+void* operator new[](size_t size) {return operator new(size);}
+void* operator new(size_t size, const std::nothrow_t&) noexcept {return malloc(size);}
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {return malloc(size);}
+void operator delete(void* ptr) noexcept {free(ptr);}
+void operator delete[](void* ptr) noexcept {free(ptr);}
+void operator delete(void* ptr, size_t) noexcept {free(ptr);}
+void operator delete[](void* ptr, size_t) noexcept {free(ptr);}
+
+
+namespace NativeHeap {
+  size_t capacity() {return arenaEnd;}
+
+  bool setCapacity(size_t size) {
+    HeapGuard guard;
+    initialize();
+    size &= ~(Alignment - 1);
+    if (size > NATIVE_HEAP_ARENA_SIZE) return false;
+    Block* prev = nullptr;
+    Block* tail = freeList;
+    while (tail != nullptr && tail->next != nullptr) {
+      prev = tail;
+      tail = tail->next;
+    }
+    uint8_t* end = arena + arenaEnd;
+    bool tailReachesEnd = tail && reinterpret_cast<uint8_t*>(tail) + tail->size == end;
+    if (size < arenaEnd) {
+      if (!tailReachesEnd) return false;
+      auto tailStart = static_cast<size_t>(reinterpret_cast<uint8_t*>(tail) - arena);
+      if (tailStart == size) {
+        if (prev) prev->next = nullptr;
+        else freeList = nullptr;
+      } else if (tailStart + MinBlockSize <= size) {
+        tail->size = size - tailStart;
+      } else return false;
+    } else if (size > arenaEnd) {
+      if (tailReachesEnd) tail->size += size - arenaEnd;
+      else {
+        auto block = reinterpret_cast<Block*>(end);
+        block->size = size - arenaEnd;
+        block->next = nullptr;
+        if (tail) tail->next = block;
+        else freeList = block;
+      }
+    }
+    arenaEnd = size;
+    return true;
+  }
+
+  size_t used() {return usedBytes;}
+  size_t peak() {return peakBytes;}
+  void resetPeak() {peakBytes = usedBytes;}
+  size_t freeBytes() {return arenaEnd - usedBytes;}
+  uint32_t allocations() {return allocationCount;}
+
+  size_t largestFreeBlock() {
+    HeapGuard guard;
+    initialize();
+    size_t largest = 0;
+    for (Block* block = freeList; block != nullptr; block = block->next) {
+      if (block->size > largest) largest = block->size;
+    }
+    return largest > HeaderSize ? largest - HeaderSize : 0;
+  }
+
+  uint8_t fragmentation() {
+    size_t free = freeBytes();
+    if (free == 0) return 0;
+    return static_cast<uint8_t>(100 - (largestFreeBlock() * 100) / free);
+  }
+}
@@ -0,0 +1,22 @@
+#ifndef NATIVE_HEAP_H
+#define NATIVE_HEAP_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Simulated device heap for the native build.
+// malloc/free/realloc/calloc are wrapped at link time (-Wl,--wrap=...) and served from a fixed
+// first-fit arena, so free heap, largest free block and fragmentation mean the same thing they do on the ESP.
+namespace NativeHeap {
+  size_t capacity();
+  bool setCapacity(size_t size);      // fails if allocated blocks lie above the new end
+  size_t used();
+  size_t peak();
+  void resetPeak();
+  size_t freeBytes();
+  size_t largestFreeBlock();
+  uint8_t fragmentation();            // 0..100, same formula as ESP.getHeapFragmentation()
+  uint32_t allocations();
+}
+
+#endif
@@ -0,0 +1,29 @@
+#include "Print.h"
+
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+
+size_t Print::write(const uint8_t* buffer, size_t size) {
+  size_t written = 0;
+  while (size--) {
+    if (write(*buffer++) == 0) break;
+    written++;
+  }
+  return written;
+}
+
+size_t Print::write(const char* str) {
+  if (str == nullptr) return 0;
+  return write(reinterpret_cast<const uint8_t*>(str), strlen(str));
+}
+
+size_t Print::printf(const char* format, ...) {
+  char buffer[256];
+  va_list args;
+  va_start(args, format);
+  int length = vsnprintf(buffer, sizeof(buffer), format, args);
+  va_end(args);
+  if (length < 0) return 0;
+  return write(buffer, static_cast<size_t>(length) < sizeof(buffer) ? length : sizeof(buffer) - 1);
+}
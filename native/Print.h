@@ -0,0 +1,36 @@
+#ifndef NATIVE_PRINT_H
+#define NATIVE_PRINT_H
+
+#include <cstddef>
+#include <cstdint>
+#include "WString.h"
+
+#define DEC 10
+#define HEX 16
+
+class Print {
+public:
+  virtual ~Print() = default;
+  virtual size_t write(uint8_t c) = 0;
+  virtual size_t write(const uint8_t* buffer, size_t size);
+  size_t write(const char* str);
+  size_t write(const char* buffer, size_t size) {return write(reinterpret_cast<const uint8_t*>(buffer), size);}
+  virtual int availableForWrite() {return 0;}
+  virtual void flush() {}
+
+  size_t print(const char* str) {return write(str);}
+  size_t print(const String& str) {return write(str.c_str(), str.length());}
+  size_t print(char c) {return write(static_cast<uint8_t>(c));}
+  size_t print(int value, int base = DEC) {return print(String(value, static_cast<unsigned char>(base)));}
+  size_t print(unsigned int value, int base = DEC) {return print(String(value, static_cast<unsigned char>(base)));}
+  size_t print(long value, int base = DEC) {return print(String(value, static_cast<unsigned char>(base)));}
+  size_t print(unsigned long value, int base = DEC) {return print(String(value, static_cast<unsigned char>(base)));}
+  size_t print(double value, int digits = 2) {return print(String(value, static_cast<unsigned char>(digits)));}
+  size_t printf(const char* format, ...) __attribute__((format(printf, 2, 3)));
+
+  size_t println() {return write("\r\n");}
+  template <typename T> size_t println(const T& value) {return print(value) + println();}
+  template <typename T> size_t println(const T& value, int format) {return print(value, format) + println();}
+};
+
+#endif
@@ -0,0 +1,60 @@
+#include "Stream.h"
+
+#include <cstring>
+
+// Host streams never block, so a read past the end is reported immediately instead of after the timeout.
+int Stream::timedRead() {
+  return read();
+}
+
+size_t Stream::readBytes(char* buffer, size_t length) {
+  size_t count = 0;
+  while (count < length) {
+    int c = timedRead();
+    if (c < 0) break;
+    buffer[count++] = static_cast<char>(c);
+  }
+  return count;
+}
+
+bool Stream::find(const char* target) {
+  return find(target, strlen(target));
+}
+
+bool Stream::find(const char* target, size_t length) {
+  if (length == 0) return true;
+  size_t matched = 0;
+  int c;
+  while ((c = timedRead()) >= 0) {
+    if (c == target[matched]) {
+      if (++matched == length) return true;
+    } else matched = (c == target[0]) ? 1 : 0;
+  }
+  return false;
+}
+
+bool Stream::findUntil(const char* target, const char* terminator) {
+  size_t targetLength = strlen(target);
+  size_t terminatorLength = strlen(terminator);
+  size_t targetMatched = 0;
+  size_t terminatorMatched = 0;
+  int c;
+  while ((c = timedRead()) >= 0) {
+    if (c == target[targetMatched]) {
+      if (++targetMatched == targetLength) return true;
+    } else targetMatched = (c == target[0]) ? 1 : 0;
+    if (terminatorLength > 0) {
+      if (c == terminator[terminatorMatched]) {
+        if (++terminatorMatched == terminatorLength) return false;
+      } else terminatorMatched = (c == terminator[0]) ? 1 : 0;
+    }
+  }
+  return false;
+}
+
+String Stream::readString() {
+  String result;
+  int c;
+  while ((c = timedRead()) >= 0) result += static_cast<char>(c);
+  return result;
+}
@@ -0,0 +1,27 @@
+#ifndef NATIVE_STREAM_H
+#define NATIVE_STREAM_H
+
+#include "Print.h"
+
+class Stream : public Print {
+public:
+  virtual int available() = 0;
+  virtual int read() = 0;
+  virtual int peek() = 0;
+
+  void setTimeout(unsigned long timeout) {this->timeout = timeout;}
+  unsigned long getTimeout() const {return timeout;}
+  virtual size_t readBytes(char* buffer, size_t length);       // virtual like on the ESP32 core, where File reads a whole block
+  size_t readBytes(uint8_t* buffer, size_t length) {return readBytes(reinterpret_cast<char*>(buffer), length);}
+  bool find(const char* target);
+  bool find(char target) {return find(&target, 1);}
+  bool find(const char* target, size_t length);
+  bool findUntil(const char* target, const char* terminator);
+  String readString();
+
+protected:
+  int timedRead();
+  unsigned long timeout = 1000;
+};
+
+#endif
@@ -0,0 +1,34 @@
+#ifndef NATIVE_STREAM_STRING_H
+#define NATIVE_STREAM_STRING_H
+
+#include "Stream.h"
+
+class StreamString : public Stream, public String {
+public:
+  size_t write(const uint8_t* buffer, size_t size) override {
+    return concat(reinterpret_cast<const char*>(buffer), size) ? size : 0;
+  }
+  size_t write(uint8_t c) override {
+    return concat(static_cast<char>(c)) ? 1 : 0;
+  }
+  using Print::write;
+
+  int available() override {return static_cast<int>(length() - readPosition);}
+  int read() override {
+    if (readPosition >= length()) return -1;
+    return static_cast<unsigned char>(charAt(readPosition++));
+  }
+  int peek() override {
+    if (readPosition >= length()) return -1;
+    return static_cast<unsigned char>(charAt(readPosition));
+  }
+  void clear() {
+    String::clear();
+    readPosition = 0;
+  }
+
+private:
+  size_t readPosition = 0;
+};
+
+#endif
@@ -0,0 +1,236 @@
+#include "WString.h"
+
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+String::String(const char* cstr) : buffer(nullptr), capacity(0), len(0) {
+  if (cstr) copy(cstr, strlen(cstr));
+}
+
+String::String(const char* cstr, size_t length) : buffer(nullptr), capacity(0), len(0) {
+  if (cstr) copy(cstr, length);
+}
+
+String::String(const String& other) : buffer(nullptr), capacity(0), len(0) {
+  copy(other.c_str(), other.len);
+}
+
+String::String(String&& other) noexcept : buffer(other.buffer), capacity(other.capacity), len(other.len) {
+  other.buffer = nullptr;
+  other.capacity = 0;
+  other.len = 0;
+}
+
+String::String(char c) : buffer(nullptr), capacity(0), len(0) {
+  copy(&c, 1);
+}
+
+namespace {
+  void formatInteger(char* out, size_t size, unsigned long value, unsigned char base, bool negative) {
+    char digits[sizeof(unsigned long) * 8 + 2];
+    size_t count = 0;
+    if (base < 2) base = 10;
+    do {
+      unsigned long digit = value % base;
+      digits[count++] = static_cast<char>(digit < 10 ? '0' + digit : 'a' + digit - 10);
+      value /= base;
+    } while (value != 0 && count < sizeof(digits));
+    size_t pos = 0;
+    if (negative && pos + 1 < size) out[pos++] = '-';
+    while (count > 0 && pos + 1 < size) out[pos++] = digits[--count];
+    out[pos] = '\0';
+  }
+}
+
+String::String(int value, unsigned char base) : String(static_cast<long>(value), base) {}
+
+String::String(unsigned int value, unsigned char base) : String(static_cast<unsigned long>(value), base) {}
+
+String::String(long value, unsigned char base) : buffer(nullptr), capacity(0), len(0) {
+  char out[sizeof(long) * 8 + 2];
+  bool negative = value < 0 && base == 10;
+  unsigned long magnitude = negative ? 0UL - static_cast<unsigned long>(value) : static_cast<unsigned long>(value);
+  formatInteger(out, sizeof(out), magnitude, base, negative);
+  copy(out, strlen(out));
+}
+
+String::String(unsigned long value, unsigned char base) : buffer(nullptr), capacity(0), len(0) {
+  char out[sizeof(unsigned long) * 8 + 2];
+  formatInteger(out, sizeof(out), value, base, false);
+  copy(out, strlen(out));
+}
+
+String::String(float value, unsigned char decimalPlaces) : String(static_cast<double>(value), decimalPlaces) {}
+
+String::String(double value, unsigned char decimalPlaces) : buffer(nullptr), capacity(0), len(0) {
+  char out[64];
+  snprintf(out, sizeof(out), "%.*f", decimalPlaces, value);
+  copy(out, strlen(out));
+}
+
+String::~String() {
+  free(buffer);
+}
+
+String& String::operator=(const String& other) {
+  if (this != &other) copy(other.c_str(), other.len);
+  return *this;
+}
+
+String& String::operator=(String&& other) noexcept {
+  if (this != &other) {
+    free(buffer);
+    buffer = other.buffer;
+    capacity = other.capacity;
+    len = other.len;
+    other.buffer = nullptr;
+    other.capacity = 0;
+    other.len = 0;
+  }
+  return *this;
+}
+
+String& String::operator=(const char* cstr) {
+  if (cstr) copy(cstr, strlen(cstr));
+  else clear();
+  return *this;
+}
+
+bool String::reserve(size_t size) {
+  if (buffer && capacity >= size) return true;
+  auto newBuffer = static_cast<char*>(realloc(buffer, size + 1));
+  if (newBuffer == nullptr) return false;
+  if (buffer == nullptr) newBuffer[0] = '\0';
+  buffer = newBuffer;
+  capacity = size;
+  return true;
+}
+
+void String::clear() {
+  len = 0;
+  if (buffer) buffer[0] = '\0';
+}
+
+bool String::copy(const char* cstr, size_t length) {
+  if (length == 0) {
+    clear();
+    return true;
+  }
+  if (!reserve(length)) {
+    clear();
+    return false;
+  }
+  memmove(buffer, cstr, length);
+  buffer[length] = '\0';
+  len = length;
+  return true;
+}
+
+bool String::concat(const char* cstr, size_t length) {
+  if (cstr == nullptr) return false;
+  if (length == 0) return true;
+  size_t newLength = len + length;
+  if (capacity < newLength) {
+    size_t grown = capacity + capacity / 2;
+    if (!reserve(grown > newLength ? grown : newLength)) return false;
+  }
+  memmove(buffer + len, cstr, length);
+  len = newLength;
+  buffer[len] = '\0';
+  return true;
+}
+
+bool String::concat(const String& other) {return concat(other.c_str(), other.len);}
+bool String::concat(const char* cstr) {return cstr && concat(cstr, strlen(cstr));}
+bool String::concat(char c) {return concat(&c, 1);}
+bool String::concat(int value) {return concat(String(value));}
+bool String::concat(unsigned int value) {return concat(String(value));}
+bool String::concat(long value) {return concat(String(value));}
+bool String::concat(unsigned long value) {return concat(String(value));}
+bool String::concat(double value) {return concat(String(value));}
+
+bool String::equals(const String& other) const {
+  return len == other.len && memcmp(c_str(), other.c_str(), len) == 0;
+}
+
+bool String::equals(const char* cstr) const {
+  if (cstr == nullptr) return len == 0;
+  return strcmp(c_str(), cstr) == 0;
+}
+
+bool String::equalsIgnoreCase(const String& other) const {
+  if (len != other.len) return false;
+  for (size_t i = 0; i < len; i++) {
+    if (tolower(static_cast<unsigned char>(buffer[i])) != tolower(static_cast<unsigned char>(other.buffer[i]))) return false;
+  }
+  return true;
+}
+
+bool String::startsWith(const String& prefix) const {
+  return prefix.len <= len && memcmp(c_str(), prefix.c_str(), prefix.len) == 0;
+}
+
+bool String::endsWith(const String& suffix) const {
+  return suffix.len <= len && memcmp(c_str() + len - suffix.len, suffix.c_str(), suffix.len) == 0;
+}
+
+char String::charAt(size_t index) const {
+  return index < len ? buffer[index] : '\0';
+}
+
+int String::indexOf(char c, size_t from) const {
+  if (from >= len) return -1;
+  auto found = static_cast<const char*>(memchr(buffer + from, c, len - from));
+  return found ? static_cast<int>(found - buffer) : -1;
+}
+
+int String::indexOf(const char* str, size_t from) const {
+  if (str == nullptr || from >= len) return -1;
+  const char* found = strstr(buffer + from, str);
+  return found ? static_cast<int>(found - buffer) : -1;
+}
+
+String String::substring(size_t from, size_t to) const {
+  if (from > to) {
+    size_t tmp = from;
+    from = to;
+    to = tmp;
+  }
+  if (from >= len) return String();
+  if (to > len) to = len;
+  return String(buffer + from, to - from);
+}
+
+void String::trim() {
+  if (len == 0) return;
+  size_t begin = 0;
+  while (begin < len && isspace(static_cast<unsigned char>(buffer[begin]))) begin++;
+  size_t end = len;
+  while (end > begin && isspace(static_cast<unsigned char>(buffer[end - 1]))) end--;
+  len = end - begin;
+  memmove(buffer, buffer + begin, len);
+  buffer[len] = '\0';
+}
+
+long String::toInt() const {return strtol(c_str(), nullptr, 10);}
+float String::toFloat() const {return strtof(c_str(), nullptr);}
+
+String operator+(const String& lhs, const String& rhs) {
+  String result(lhs);
+  result.concat(rhs);
+  return result;
+}
+
+String operator+(const String& lhs, const char* rhs) {
+  String result(lhs);
+  result.concat(rhs);
+  return result;
+}
+
+String operator+(const char* lhs, const String& rhs) {
+  String result(lhs);
+  result.concat(rhs);
+  return result;
+}
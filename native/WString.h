@@ -0,0 +1,87 @@
+#ifndef NATIVE_WSTRING_H
+#define NATIVE_WSTRING_H
+
+#include <cstddef>
+#include <cstdint>
+
+class __FlashStringHelper;
+
+// Host stand-in for the Arduino String class, heap allocations go through malloc like on the device.
+class String {
+public:
+  String(const char* cstr = "");
+  String(const char* cstr, size_t length);
+  String(const String& other);
+  String(String&& other) noexcept;
+  explicit String(char c);
+  explicit String(int value, unsigned char base = 10);
+  explicit String(unsigned int value, unsigned char base = 10);
+  explicit String(long value, unsigned char base = 10);
+  explicit String(unsigned long value, unsigned char base = 10);
+  explicit String(float value, unsigned char decimalPlaces = 2);
+  explicit String(double value, unsigned char decimalPlaces = 2);
+  ~String();
+
+  String& operator=(const String& other);
+  String& operator=(String&& other) noexcept;
+  String& operator=(const char* cstr);
+
+  bool reserve(size_t size);
+  void clear();
+  size_t length() const {return len;}
+  bool isEmpty() const {return len == 0;}
+  const char* c_str() const {return buffer ? buffer : "";}
+  char* begin() {return buffer;}
+  char* end() {return buffer + len;}
+
+  bool concat(const String& other);
+  bool concat(const char* cstr);
+  bool concat(const char* cstr, size_t length);
+  bool concat(char c);
+  bool concat(int value);
+  bool concat(unsigned int value);
+  bool concat(long value);
+  bool concat(unsigned long value);
+  bool concat(double value);
+
+  String& operator+=(const String& other) {concat(other); return *this;}
+  String& operator+=(const char* cstr) {concat(cstr); return *this;}
+  String& operator+=(char c) {concat(c); return *this;}
+  String& operator+=(int value) {concat(value); return *this;}
+  String& operator+=(unsigned int value) {concat(value); return *this;}
+  String& operator+=(long value) {concat(value); return *this;}
+  String& operator+=(unsigned long value) {concat(value); return *this;}
+
+  bool equals(const String& other) const;
+  bool equals(const char* cstr) const;
+  bool equalsIgnoreCase(const String& other) const;
+  bool startsWith(const String& prefix) const;
+  bool endsWith(const String& suffix) const;
+  bool operator==(const String& other) const {return equals(other);}
+  bool operator==(const char* cstr) const {return equals(cstr);}
+  bool operator!=(const String& other) const {return !equals(other);}
+  bool operator!=(const char* cstr) const {return !equals(cstr);}
+
+  char charAt(size_t index) const;
+  char operator[](size_t index) const {return charAt(index);}
+  int indexOf(char c, size_t from = 0) const;
+  int indexOf(const char* str, size_t from = 0) const;
+  int indexOf(const String& str, size_t from = 0) const {return indexOf(str.c_str(), from);}
+  String substring(size_t from) const {return substring(from, len);}
+  String substring(size_t from, size_t to) const;
+  void trim();
+  long toInt() const;
+  float toFloat() const;
+
+private:
+  bool copy(const char* cstr, size_t length);
+  char* buffer;
+  size_t capacity;
+  size_t len;
+};
+
+String operator+(const String& lhs, const String& rhs);
+String operator+(const String& lhs, const char* rhs);
+String operator+(const char* lhs, const String& rhs);
+
+#endif
@@ -0,0 +1,34 @@
+#ifndef NATIVE_WIFI_H
+#define NATIVE_WIFI_H
+
+#include <functional>
+#include "Arduino.h"
+
+typedef enum {
+  SYSTEM_EVENT_STA_CONNECTED,
+  SYSTEM_EVENT_STA_DISCONNECTED,
+  SYSTEM_EVENT_AP_STACONNECTED,
+  SYSTEM_EVENT_AP_STADISCONNECTED,
+} system_event_id_t;
+
+typedef system_event_id_t WiFiEvent_t;
+typedef struct {uint32_t reserved;} WiFiEventInfo_t;
+typedef std::function<void(WiFiEvent_t event, WiFiEventInfo_t info)> WiFiEventFuncCb;
+
+class WiFiClass {
+public:
+  bool softAP(const char* ssid, const char* passphrase = nullptr) {
+    (void)ssid;
+    (void)passphrase;
+    return true;
+  }
+  int onEvent(WiFiEventFuncCb callback, WiFiEvent_t event) {
+    (void)callback;
+    (void)event;
+    return 0;
+  }
+};
+
+extern WiFiClass WiFi;
+
+#endif
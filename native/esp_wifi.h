@@ -0,0 +1,6 @@
+#ifndef NATIVE_ESP_WIFI_H
+#define NATIVE_ESP_WIFI_H
+
+// Nothing from esp_wifi.h is used on the host.
+
+#endif
@@ -16,14 +16,61 @@
 #include <StreamString.h>
 #include <sstream>
 #include <vector>
+#include <new>
+#include <memory>
+#include <atomic>
 
 #include <ArduinoJson.h>
 
 #define DEBUG_BUILD 1
 
+// Visuino serial link, override with build flags: -D VISUINO_BAUD_RATE=115200 -D VISUINO_LINK_BINARY
+#ifndef VISUINO_BAUD_RATE
+#define VISUINO_BAUD_RATE 9600
+#endif
+// Share of the Visuino link the log may take, a tenth by default (8N1: ten bits per byte)
+#ifndef SERIAL_LOG_BYTES_PER_SECOND
+#define SERIAL_LOG_BYTES_PER_SECOND (VISUINO_BAUD_RATE / 100)
+#endif
+
+// How long an HTTP handler waits for busy JSON memory before answering 204.
+// ESP8266 runs handlers and loop() in one thread, waiting there could never succeed.
+#ifndef JSON_MEMORY_WAIT_MS
+#ifdef ESP32
+#define JSON_MEMORY_WAIT_MS 5
+#else
+#define JSON_MEMORY_WAIT_MS 0
+#endif
+#endif
+
+// Document size for one element of a streamed layout, a bigger element is reported as JSON overflow
+#ifndef JSON_ELEMENT_CAPACITY
+#define JSON_ELEMENT_CAPACITY 1024
+#endif
+
+// Cache-Control max-age of the website's scripts, styles and icon, in seconds. The page itself is revalidated on every load.
+#ifndef ASSET_MAX_AGE
+#define ASSET_MAX_AGE 604800
+#endif
+// RAM kept for the most requested small website files, 0 serves everything from SPIFFS
+#ifndef ASSET_CACHE_BYTES
+#define ASSET_CACHE_BYTES 16384
+#endif
+#define ASSET_STRINGIFY(value) #value
+#define ASSET_TO_STRING(value) ASSET_STRINGIFY(value)
+
+// RAM all request bodies being reassembled may hold together, a bigger body is refused with 413
+#ifndef BODY_BUFFER_BUDGET
+#define BODY_BUFFER_BUDGET 8192
+#endif
+
 namespace WebsiteServer {
+const char* LayoutPath PROGMEM = "/layout.json";                // streamed at boot when present, else the built-in layout is used
+const char* SnapshotPath PROGMEM = "/layout.bin";               // the card built from the layout, loaded instead of parsing it again
   
 AsyncWebServer server(80);
+AsyncEventSource events("/events");
+AsyncWebSocket ws("/ws");
 
 
 const uint8_t CONNECT_ATTEMPTS_MAX = 10;
@@ -38,9 +85,14 @@ const char* CORS_ALLOWED_HEADERS PROGMEM = "Origin, X-Requested-With, Content-Ty
 
 const uint16_t HTTP_STATUS_OK PROGMEM = 200;
 const uint16_t HTTP_STATUS_OK_NO_CONTENT PROGMEM = 204;
+const uint16_t HTTP_STATUS_NOT_MODIFIED PROGMEM = 304;
 const uint16_t HTTP_STATUS_BAD_REQUEST PROGMEM = 400;
+const uint16_t HTTP_STATUS_NOT_FOUND PROGMEM = 404;
+const uint16_t HTTP_STATUS_PAYLOAD_TOO_LARGE PROGMEM = 413;
 const uint16_t HTTP_STATUS_INTERNAL_SERVER_ERROR PROGMEM = 500;
 
+const char* HTTP_PARAM_SINCE PROGMEM = "since";
+
 
 
 namespace DefaultValues {
@@ -100,6 +152,8 @@ namespace JsonKey {
   const char* MaxValue PROGMEM = "maxValue";
   const char* MinValue PROGMEM = "minValue";
 
+  const char* Version PROGMEM = "version";
+
 }
 
 
@@ -123,20 +177,187 @@ namespace ErrorMessage {
     const char* ComponentTypeNotFound = "Json Input - componentType not found";
     const char* OK PROGMEM = "Json Input - Ok";
   }
+
+  namespace Snapshot {
+    const char* Loaded PROGMEM = "Snapshot - layout loaded";
+    const char* Missing PROGMEM = "Snapshot - not found, layout parsed";
+    const char* Stale PROGMEM = "Snapshot - taken from another layout or firmware, layout parsed";
+    const char* Corrupt PROGMEM = "Snapshot - damaged, layout parsed";
+    const char* AllocError PROGMEM = "Snapshot - Allocation Error, layout parsed";
+    const char* SaveFailed PROGMEM = "Snapshot - could not be saved";
+  }
 }
 
+  // Fixed ring of binary records - message, up to two arguments, time - instead of text, so logging never grows the heap.
+  // A message occurring again while its record waits for the serial link only bumps that record's count, and a message
+  // starts at most one record per RepeatIntervalMs, occurrences in between are counted into its next record.
+  // loop() drains the records as text lines within SERIAL_LOG_BYTES_PER_SECOND, /log returns every record still in the ring.
+  // Writers never wait: when another task is logging or the log is being read, the message is counted as lost.
   namespace Log {
-    StreamString errorStream;
-    bool isDataReady = false;
     const char* InfoHeader PROGMEM = "Server Info: ";
     const char* ErrorHeader PROGMEM = "Server Error: ";
+    const char* OtherMessage PROGMEM = "(message table full)";
+    const char* LostMessages PROGMEM = "Log messages lost: ";
 
     const char* MemStats PROGMEM = "Memory stats: ";
     const char* HeapFragmentationMsg PROGMEM = "- Heap fragmentation: ";
     const char* FreeHeapMsg PROGMEM = "- Free heap: ";
     const char* MaxFreeHeapBlock PROGMEM = "- Largest free memory block: ";
 
-    void memoryInfo(Stream& stream = errorStream) {
+    const char* LayoutBudgetMsg PROGMEM = "JSON memory budget, layout input: ";
+    const char* ComponentBudgetMsg PROGMEM = "JSON memory budget, component output: ";
+    const char* VisuinoBudgetMsg PROGMEM = "JSON memory budget, Visuino output: ";
+
+    const uint8_t RingCapacity = 64;                            // power of two
+    const uint8_t MessageCapacity = 64;
+    const uint16_t RepeatIntervalMs = 1000;
+    const uint8_t MaxLineLength = 128;
+
+    struct Record {
+      uint32_t timeMs;                                          // latest occurrence
+      uint32_t args[2];                                         // errors: free heap and largest free block
+      uint16_t repeats;                                         // occurrences it stands for
+      uint8_t message;
+      uint8_t argCount : 2;
+      bool isError : 1;
+    };
+
+    struct Message {
+      const char* text;
+      uint32_t lastRecord;                                      // sequence number of its newest record
+      uint32_t startedAt;                                       // when that record was started
+      uint16_t suppressed;                                      // occurrences held back by the rate limit since
+      bool recorded;
+    };
+
+    // every message has at most one record waiting for the link, so no record is overwritten before it was sent
+    static_assert(MessageCapacity <= RingCapacity, "the log ring has to hold a waiting record per message");
+    Record ring[RingCapacity];
+    Message messages[MessageCapacity] = {{OtherMessage, 0, 0, 0, false}};
+    uint8_t messageCount = 1;
+    uint32_t head = 0;                                          // sequence number of the next record
+    uint32_t drained = 0;                                       // first record not written to the serial link yet
+    uint32_t creditByteMs = MaxLineLength * 1000u;              // serial budget, bytes times milliseconds
+    uint32_t creditAt = 0;
+    std::atomic<uint32_t> lost {0};
+    std::atomic_flag busy = ATOMIC_FLAG_INIT;
+
+    uint8_t intern(const char* text) {
+      for(uint8_t i = 1; i < messageCount; i++) {
+        if(messages[i].text == text || !strcmp(messages[i].text, text)) return i;
+      }
+      if(messageCount == MessageCapacity) return 0;
+      messages[messageCount] = Message {text, 0, 0, 0, false};
+      return messageCount++;
+    }
+
+    void record(const char* text, bool isError, uint8_t argCount, uint32_t arg0 = 0, uint32_t arg1 = 0) {
+      if(busy.test_and_set(std::memory_order_acquire)) {
+        lost.fetch_add(1, std::memory_order_relaxed);
+        return;
+      }
+      uint32_t now = millis();
+      uint8_t id = intern(text);
+      Message& message = messages[id];
+      bool waiting = message.recorded && static_cast<int32_t>(message.lastRecord - drained) >= 0;
+      if(waiting) {
+        Record& last = ring[message.lastRecord % RingCapacity];
+        if(last.repeats < UINT16_MAX) last.repeats++;
+        last.timeMs = now;
+        last.args[0] = arg0;
+        last.args[1] = arg1;
+      } else if(message.recorded && now - message.startedAt < RepeatIntervalMs) {
+        if(message.suppressed < UINT16_MAX) message.suppressed++;
+      } else {
+        ring[head % RingCapacity] = Record {now, {arg0, arg1}, static_cast<uint16_t>(1 + message.suppressed), id, argCount, isError};
+        message.suppressed = 0;
+        message.lastRecord = head++;
+        message.startedAt = now;
+        message.recorded = true;
+      }
+      busy.clear(std::memory_order_release);
+    }
+
+    void info(const char* msg) {record(msg, false, 0);}
+    void info(const char* msg, uint32_t value) {record(msg, false, 1, value);}
+    void error(const char* msg) {
+#ifdef ESP8266
+      record(msg, true, 2, ESP.getFreeHeap(), ESP.getMaxFreeBlockSize());
+#endif
+#ifdef ESP32
+      record(msg, true, 2, ESP.getFreeHeap(), ESP.getMaxAllocHeap());
+#endif
+    }
+
+    // one record as a text line, returns its length
+    size_t format(const Record& record, char* line, size_t size) {
+      int length = snprintf(line, size, "%lu.%03lu %s%s", static_cast<unsigned long>(record.timeMs / 1000),
+                            static_cast<unsigned long>(record.timeMs % 1000), record.isError ? ErrorHeader : InfoHeader,
+                            messages[record.message].text);
+      if(record.isError && record.argCount == 2 && length >= 0 && static_cast<size_t>(length) < size) {
+        length += snprintf(line + length, size - length, " (free heap %lu, largest block %lu)",
+                           static_cast<unsigned long>(record.args[0]), static_cast<unsigned long>(record.args[1]));
+      } else if(record.argCount == 1 && length >= 0 && static_cast<size_t>(length) < size) {
+        length += snprintf(line + length, size - length, "%lu", static_cast<unsigned long>(record.args[0]));
+      }
+      if(record.repeats > 1 && length >= 0 && static_cast<size_t>(length) < size) {
+        length += snprintf(line + length, size - length, " x%u", record.repeats);
+      }
+      if(length < 0) length = 0;
+      if(static_cast<size_t>(length) > size - 2) length = size - 2;   // cut, the line still ends
+      line[length++] = '\n';
+      line[length] = '\0';
+      return length;
+    }
+
+    // The next line not sent yet, once the serial budget has earned its length; 0 if there is none.
+    // timeMs is when the line's message last occurred.
+    size_t take(char* line, size_t size, uint32_t& timeMs) {
+      uint32_t now = millis();
+      uint32_t earned = std::min<uint32_t>(now - creditAt, 10000) * SERIAL_LOG_BYTES_PER_SECOND;
+      creditByteMs = std::min<uint32_t>(creditByteMs + earned, MaxLineLength * 1000u);
+      creditAt = now;
+      uint32_t missing = lost.load(std::memory_order_relaxed);
+      if(missing > 0) {
+        size_t length = snprintf(line, size, "%s%s%lu\n", ErrorHeader, LostMessages, static_cast<unsigned long>(missing));
+        if(length * 1000 > creditByteMs) return 0;
+        lost.fetch_sub(missing, std::memory_order_relaxed);
+        creditByteMs -= length * 1000;
+        timeMs = now;
+        return length;
+      }
+      if(busy.test_and_set(std::memory_order_acquire)) return 0;
+      size_t length = drained != head ? format(ring[drained % RingCapacity], line, size) : 0;
+      bool fits = length > 0 && length * 1000 <= creditByteMs;
+      if(fits) timeMs = ring[drained++ % RingCapacity].timeMs;
+      busy.clear(std::memory_order_release);
+      if(!fits) return 0;
+      creditByteMs -= length * 1000;
+      return length;
+    }
+
+    // Writes every line the budget allows
+    void drain(Print& out) {
+      char line[MaxLineLength];
+      uint32_t timeMs;
+      for(size_t length; (length = take(line, sizeof(line), timeMs)) > 0;) out.write(reinterpret_cast<const uint8_t*>(line), length);
+    }
+
+    // Every record in the ring, oldest first, sent or not. Stops early when a writer holds the ring, false if nothing was printed.
+    bool print(Print& out) {
+      char line[MaxLineLength];
+      for(uint32_t sequence = 0;; sequence++) {
+        if(busy.test_and_set(std::memory_order_acquire)) return sequence > 0;
+        uint32_t oldest = head > RingCapacity ? head - RingCapacity : 0;
+        if(sequence < oldest) sequence = oldest;
+        size_t length = sequence < head ? format(ring[sequence % RingCapacity], line, sizeof(line)) : 0;
+        busy.clear(std::memory_order_release);
+        if(length == 0) return true;
+        out.write(reinterpret_cast<const uint8_t*>(line), length);
+      }
+    }
+
+    void memoryInfo(Stream& stream) {
 #ifdef ESP8266
       stream.println(MemStats);
 
@@ -159,28 +380,267 @@ namespace ErrorMessage {
       stream.print(ESP.getMaxAllocHeap());
 #endif
       stream.println();
-      isDataReady = true;
     }
-    void info (const char* msg, Stream& stream = errorStream) {
-      stream.print(InfoHeader);
-      stream.print(" ");
-      stream.println(msg);
-      isDataReady = true;
+  }
+
+
+// Input component events for the Visuino serial link, written either as JSON lines or as compact binary frames.
+// Binary frame, multi-byte fields little endian:
+//   0xA5 | id (2) | type tag (1) | value (1 for switch/button, 4 for slider/numberInput) | CRC-16/CCITT-FALSE of id..value (2)
+// id is the component's position in the layout, both ends know the layout so the name is not sent.
+namespace Visuino {
+  enum class LinkFormat : uint8_t {JSON, BINARY};
+  enum class TypeTag : uint8_t {
+    SWITCH = 1,
+    SLIDER = 2,
+    NUMBER_INPUT = 3,
+    BUTTON = 4,
+  };
+
+  struct Event {
+    uint16_t id;
+    TypeTag type;
+    uint32_t value;     // bool as 0/1, slider value, numberInput float bits
+  };
+
+  const uint8_t FrameSync PROGMEM = 0xA5;
+  const uint8_t FrameHeaderSize PROGMEM = 4;
+  const uint8_t FrameCrcSize PROGMEM = 2;
+  const uint8_t MaxFrameSize PROGMEM = FrameHeaderSize + 4 + FrameCrcSize;
+
+#ifdef VISUINO_LINK_BINARY
+  LinkFormat linkFormat = LinkFormat::BINARY;
+#else
+  LinkFormat linkFormat = LinkFormat::JSON;
+#endif
+  void setLinkFormat(LinkFormat format) {linkFormat = format;}
+
+  uint32_t packFloat(float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+  }
+
+  float unpackFloat(uint32_t bits) {
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+  }
+
+  // 0 for unknown tags, the decoder uses it to reject garbage
+  uint8_t valueSize(TypeTag type) {
+    switch (type) {
+      case TypeTag::SWITCH:
+      case TypeTag::BUTTON:
+        return 1;
+      case TypeTag::SLIDER:
+      case TypeTag::NUMBER_INPUT:
+        return 4;
     }
-    void error (const char* msg, Stream& stream = errorStream) {
-      stream.print(ErrorHeader);
-      stream.print(" ");
-      stream.println(msg);
-      memoryInfo(stream);
-      isDataReady = true;
+    return 0;
+  }
+
+  uint16_t crc16(const uint8_t* data, size_t len) {
+    uint16_t crc = 0xFFFF;
+    for(size_t i = 0; i < len; i++) {
+      crc ^= static_cast<uint16_t>(data[i]) << 8;
+      for(uint8_t bit = 0; bit < 8; bit++) {
+        crc = (crc & 0x8000) ? static_cast<uint16_t>((crc << 1) ^ 0x1021) : static_cast<uint16_t>(crc << 1);
+      }
     }
+    return crc;
   }
 
+  // frame has to hold MaxFrameSize bytes, returns the frame length
+  size_t encodeFrame(const Event& event, uint8_t* frame) {
+    uint8_t size = valueSize(event.type);
+    frame[0] = FrameSync;
+    frame[1] = static_cast<uint8_t>(event.id);
+    frame[2] = static_cast<uint8_t>(event.id >> 8);
+    frame[3] = static_cast<uint8_t>(event.type);
+    for(uint8_t i = 0; i < size; i++) frame[FrameHeaderSize + i] = static_cast<uint8_t>(event.value >> (8 * i));
+    uint16_t crc = crc16(frame + 1, FrameHeaderSize - 1 + size);
+    frame[FrameHeaderSize + size] = static_cast<uint8_t>(crc);
+    frame[FrameHeaderSize + size + 1] = static_cast<uint8_t>(crc >> 8);
+    return FrameHeaderSize + size + FrameCrcSize;
+  }
+
+  // Latest value of one component which did not fit into the EventQueue, owned by the component.
+  // The producer stores the value before raising pending, the consumer clears pending before reading the value,
+  // so a value written in between is at worst sent twice, never lost.
+  struct OverflowSlot {
+    std::atomic<uint32_t> value {0};
+    std::atomic<uint32_t> parkedAt {0};       // ring tail when parked, older events of the component sit before it
+    std::atomic<uint32_t> parkedUs {0};       // micros() when the oldest value not forwarded yet was parked
+    std::atomic<bool> pending {false};
+  };
+
+  // Fixed-capacity ring of events from the AsyncTCP task(s) to loop(): any number of producers, one consumer,
+  // no locks and no allocation (bounded queue with a sequence number per cell).
+  // When the ring is full an event is parked in its component's OverflowSlot, replacing what waits there already.
+  // Once a component has a parked value its later events go to the slot too, so Visuino never sees its values out of order.
+  class EventQueue {
+  public:
+    static const uint16_t Capacity = 64;    // power of two
+
+    EventQueue() {
+      for(uint16_t i = 0; i < Capacity; i++) cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    void push(const Event& event, OverflowSlot* slot) {
+      if(slot != nullptr && slot->pending.load(std::memory_order_acquire)) {
+        park(event, slot);
+      } else if(tryPush(event)) {
+        enqueued.fetch_add(1, std::memory_order_relaxed);
+      } else if(slot != nullptr) {
+        park(event, slot);
+      } else {
+        dropped.fetch_add(1, std::memory_order_relaxed);
+      }
+    }
+
+    // Events of one /status batch take consecutive cells claimed at once, so loop() forwards them back to back.
+    // A batch which does not fit, or holds a component with a parked value, goes through push() event by event.
+    void pushBatch(const Event* events, OverflowSlot* const* slots, uint16_t count) {
+      bool claimed = count > 0 && count <= Capacity;
+      for(uint16_t i = 0; claimed && i < count; i++) claimed = !slots[i]->pending.load(std::memory_order_acquire);
+      uint32_t position = tail.load(std::memory_order_relaxed);
+      while(claimed) {
+        // the consumer frees cells in order, when the last one is free for this lap all of them are
+        uint32_t last = position + count - 1;
+        int32_t difference = static_cast<int32_t>(cells[last & (Capacity - 1)].sequence.load(std::memory_order_acquire) - last);
+        if(difference == 0) {
+          if(tail.compare_exchange_weak(position, position + count, std::memory_order_relaxed)) break;
+        } else if(difference < 0) {
+          claimed = false;
+        } else {
+          position = tail.load(std::memory_order_relaxed);
+        }
+      }
+      if(!claimed) {
+        for(uint16_t i = 0; i < count; i++) push(events[i], slots[i]);
+        return;
+      }
+      uint32_t now = micros();
+      for(uint16_t i = 0; i < count; i++) {
+        Cell& cell = cells[(position + i) & (Capacity - 1)];
+        cell.event = events[i];
+        cell.queuedAt = now;
+        cell.sequence.store(position + i + 1, std::memory_order_release);
+      }
+      enqueued.fetch_add(count, std::memory_order_relaxed);
+    }
+
+    // consumer side, loop() only. queuedAt, if given, gets the micros() the event was pushed at.
+    bool pop(Event& event, uint32_t* queuedAt = nullptr) {
+      uint32_t position = head.load(std::memory_order_relaxed);
+      Cell& cell = cells[position & (Capacity - 1)];
+      uint32_t sequence = cell.sequence.load(std::memory_order_acquire);
+      if(static_cast<int32_t>(sequence - (position + 1)) < 0) return false;
+      event = cell.event;
+      if(queuedAt != nullptr) *queuedAt = cell.queuedAt;
+      cell.sequence.store(position + Capacity, std::memory_order_release);
+      head.store(position + 1, std::memory_order_relaxed);
+      return true;
+    }
+
+    // true once after events were parked, the consumer then collects them with takeParked()
+    bool takeOverflow() {return overflowed.exchange(false, std::memory_order_acq_rel);}
+
+    // A parked value is handed out only after the ring is consumed past the point where it was parked:
+    // a producer which claimed a cell but did not fill it yet stalls pop(), and the component's older events may sit behind it.
+    bool takeParked(OverflowSlot& slot, uint32_t& latest) {
+      if(!slot.pending.load(std::memory_order_acquire)) return false;
+      uint32_t position = head.load(std::memory_order_relaxed);
+      if(static_cast<int32_t>(position - slot.parkedAt.load(std::memory_order_relaxed)) < 0) {
+        overflowed.store(true, std::memory_order_release);    // look again on the next pass
+        return false;
+      }
+      if(!slot.pending.exchange(false, std::memory_order_acq_rel)) return false;
+      latest = slot.value.load(std::memory_order_acquire);
+      return true;
+    }
+
+    uint32_t enqueuedCount() const {return enqueued.load(std::memory_order_relaxed);}
+    uint32_t coalescedCount() const {return coalesced.load(std::memory_order_relaxed);}
+    uint32_t droppedCount() const {return dropped.load(std::memory_order_relaxed);}
+
+  private:
+    struct Cell {
+      std::atomic<uint32_t> sequence;
+      Event event;
+      uint32_t queuedAt;
+    };
+
+    bool tryPush(const Event& event) {
+      uint32_t position = tail.load(std::memory_order_relaxed);
+      Cell* cell;
+      for(;;) {
+        cell = &cells[position & (Capacity - 1)];
+        uint32_t sequence = cell->sequence.load(std::memory_order_acquire);
+        int32_t difference = static_cast<int32_t>(sequence - position);
+        if(difference == 0) {
+          if(tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) break;
+        } else if(difference < 0) {
+          return false;     // full
+        } else {
+          position = tail.load(std::memory_order_relaxed);
+        }
+      }
+      cell->event = event;
+      cell->queuedAt = micros();
+      cell->sequence.store(position + 1, std::memory_order_release);
+      return true;
+    }
+
+    void park(const Event& event, OverflowSlot* slot) {
+      if(!slot->pending.load(std::memory_order_acquire)) {
+        slot->parkedAt.store(tail.load(std::memory_order_acquire), std::memory_order_relaxed);
+        slot->parkedUs.store(micros(), std::memory_order_relaxed);
+      }
+      slot->value.store(event.value, std::memory_order_release);
+      slot->pending.store(true, std::memory_order_release);
+      overflowed.store(true, std::memory_order_release);
+      coalesced.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    Cell cells[Capacity];
+    std::atomic<uint32_t> head {0};
+    std::atomic<uint32_t> tail {0};
+    std::atomic<bool> overflowed {false};
+    std::atomic<uint32_t> enqueued {0};       // went through the ring
+    std::atomic<uint32_t> coalesced {0};      // parked in an overflow slot, merged with the component's other waiting values
+    std::atomic<uint32_t> dropped {0};        // ring full and nowhere to park
+  };
+
+  EventQueue queue;
+}
 
 
-// Abstraction on Json Document which is common for few parts of app to make it thread safe
+// Abstraction on Json Document which is common for few parts of app to make it thread safe.
+// Ownership is taken with a single atomic exchange, so the AsyncTCP task and loop() can never hold it both.
 class CommonJsonMemory {
 public:
+  struct Stats {
+    uint32_t acquisitions;
+    uint32_t failures;                  // lock() calls which gave up, busy or not allocated
+    uint32_t longestHoldUs;
+  };
+
+  // Owns the memory for its scope, check it with if(guard) before using get()
+  class Guard {
+  public:
+    explicit Guard(CommonJsonMemory* memory, uint32_t timeoutMs = 0) : memory(memory) {
+      if(this->memory != nullptr && !this->memory->lock(timeoutMs)) this->memory = nullptr;
+    }
+    ~Guard() {if(memory != nullptr) memory->unlock();}
+    Guard(const Guard&) = delete;
+    Guard& operator=(const Guard&) = delete;
+    explicit operator bool() const {return memory != nullptr;}
+  private:
+    CommonJsonMemory* memory;
+  };
+
   ~CommonJsonMemory() {this->garbageCollect();}
   bool allocate(size_t size) {
     mem = new DynamicJsonDocument(size);
@@ -190,50 +650,420 @@ public:
     }
     else return false;
   }
-  void garbageCollect() {delete mem;}
-  void lock() {this->m_isLocked = true;}
-  void unlock() {this->m_isLocked = false;}
-  bool isReadyToUse() {return (!m_isLocked) && m_isInitialized;}
+  void garbageCollect() {
+    delete mem;
+    mem = nullptr;
+    m_isInitialized = false;
+  }
+  bool tryLock() {return this->lock(0);}
+  // retries until timeoutMs passes, 0 tries once
+  bool lock(uint32_t timeoutMs) {
+    if(!m_isInitialized) {
+      failures.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+    uint32_t start = millis();
+    while(!this->acquire()) {
+      if(millis() - start >= timeoutMs) {
+        failures.fetch_add(1, std::memory_order_relaxed);
+        return false;
+      }
+      delay(1);
+    }
+    return true;
+  }
+  void unlock() {
+    uint32_t held = micros() - lockedAt;
+    if(held > longestHoldUs.load(std::memory_order_relaxed)) longestHoldUs.store(held, std::memory_order_relaxed);
+    m_isLocked.store(false, std::memory_order_release);
+  }
+  bool isLocked() const {return m_isLocked.load(std::memory_order_relaxed);}
+  Stats getStats() const {
+    return {acquisitions.load(std::memory_order_relaxed), failures.load(std::memory_order_relaxed),
+            longestHoldUs.load(std::memory_order_relaxed)};
+  }
   DynamicJsonDocument* get() {return this->mem;}
 private:
-  DynamicJsonDocument* mem;
-  bool m_isLocked;
-  bool m_isInitialized;
+  bool acquire() {
+    // plain load first, a busy memory is not written to by every waiting caller
+    if(m_isLocked.load(std::memory_order_relaxed) || m_isLocked.exchange(true, std::memory_order_acquire)) return false;
+    lockedAt = micros();
+    acquisitions.fetch_add(1, std::memory_order_relaxed);
+    return true;
+  }
+  DynamicJsonDocument* mem = nullptr;
+  std::atomic<bool> m_isLocked {false};
+  bool m_isInitialized = false;
+  uint32_t lockedAt = 0;                // written by the owner only
+  std::atomic<uint32_t> acquisitions {0};
+  std::atomic<uint32_t> failures {0};
+  std::atomic<uint32_t> longestHoldUs {0};
 };
 
 namespace Website {
 
+  class InputComponent;
+  class OutputComponent;
+
+  // Bump allocator for the layout: component objects and their immutable strings lie side by side in a few big blocks,
+  // freed in one step by Card::garbageCollect(). Sized once at layout load, another chunk is added only when the estimate was short.
+  class Arena {
+  public:
+    struct Marker {
+      void* chunk;
+      size_t used;
+    };
+
+    Arena() = default;
+    ~Arena() {this->release();}
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    bool reserve(size_t size) {return this->size() >= size || this->addChunk(size - this->size());}
+    void* allocate(size_t size, size_t align);
+    // copy of str owned by the arena, nullptr when out of memory
+    const char* copy(const char* str);
+    template <typename type, typename... args> type* create(args&&... params) {
+      void* place = this->allocate(sizeof(type), alignof(type));
+      return place != nullptr ? new (place) type(std::forward<args>(params)...) : nullptr;
+    }
+    // undoes every allocation made after mark(), objects created since have to be destroyed first
+    Marker mark() const {return Marker {head, head != nullptr ? head->used : 0};}
+    void rollback(const Marker& marker);
+    void release();
+    size_t size() const;
+    size_t used() const;
+    uint16_t chunkCount() const;
+  private:
+    struct Chunk {
+      Chunk* next;
+      size_t size;
+      size_t used;
+      uint8_t* data() {return reinterpret_cast<uint8_t*>(this) + HeaderSize;}
+    };
+    static const size_t HeaderSize = (sizeof(Chunk) + alignof(std::max_align_t) - 1) & ~(alignof(std::max_align_t) - 1);
+    static const size_t MinChunkSize = 512;
+    bool addChunk(size_t size);
+    Chunk* head = nullptr;                                      // chunk being filled, older ones follow
+  };
+
+  bool Arena::addChunk(size_t size) {
+    if(size < MinChunkSize) size = MinChunkSize;
+    if(size > SIZE_MAX - HeaderSize) return false;
+    auto memory = new (std::nothrow) uint8_t[HeaderSize + size];
+    if(memory == nullptr) return false;
+    auto chunk = reinterpret_cast<Chunk*>(memory);
+    chunk->next = head;
+    chunk->size = size;
+    chunk->used = 0;
+    head = chunk;
+    return true;
+  }
+
+  void* Arena::allocate(size_t size, size_t align) {
+    if(head != nullptr) {
+      size_t start = (head->used + align - 1) & ~(align - 1);
+      if(start + size <= head->size) {
+        head->used = start + size;
+        return head->data() + start;
+      }
+    }
+    // the rest of the current chunk is left unused, a short estimate costs one more block, not a block per object
+    if(!this->addChunk(std::max(size + align, this->size() / 4))) return nullptr;
+    return this->allocate(size, align);
+  }
+
+  const char* Arena::copy(const char* str) {
+    if(str == nullptr) return nullptr;
+    size_t length = strlen(str) + 1;
+    auto place = static_cast<char*>(this->allocate(length, 1));
+    if(place != nullptr) memcpy(place, str, length);
+    return place;
+  }
+
+  void Arena::rollback(const Marker& marker) {
+    while(head != nullptr && head != marker.chunk) {
+      Chunk* next = head->next;
+      delete[] reinterpret_cast<uint8_t*>(head);
+      head = next;
+    }
+    if(head != nullptr) head->used = marker.used;
+  }
+
+  void Arena::release() {
+    this->rollback(Marker {nullptr, 0});
+  }
+
+  size_t Arena::size() const {
+    size_t total = 0;
+    for(Chunk* chunk = head; chunk != nullptr; chunk = chunk->next) total += chunk->size;
+    return total;
+  }
+
+  size_t Arena::used() const {
+    size_t total = 0;
+    for(Chunk* chunk = head; chunk != nullptr; chunk = chunk->next) total += chunk->used;
+    return total;
+  }
+
+  uint16_t Arena::chunkCount() const {
+    uint16_t count = 0;
+    for(Chunk* chunk = head; chunk != nullptr; chunk = chunk->next) count++;
+    return count;
+  }
+
+  // Open addressing hash index from a string to a 16-bit slot: component name -> Card::components, pooled string -> StringPool.
+  // Entries keep only the slot and 16 bits of the hash, the string itself is compared through nameOf(slot).
+  class ComponentIndex {
+  public:
+    static const uint16_t EmptySlot = 0xFFFF;
+    static const uint16_t MaxCapacity = 0x8000;
+    // the most names reserve() accepts, it keeps the table at most 2/3 full
+    static const uint16_t MaxComponents = (MaxCapacity - 1) * 2 / 3;
+    static_assert(MaxComponents + MaxComponents / 2 + 1 <= MaxCapacity, "reserve(MaxComponents) must fit MaxCapacity");
+    static_assert(MaxComponents < EmptySlot, "slots must not collide with EmptySlot");
+
+    ComponentIndex() = default;
+    ComponentIndex(const ComponentIndex&) = delete;
+    ComponentIndex& operator=(const ComponentIndex&) = delete;
+    ~ComponentIndex() {delete[] entries;}
+
+    static uint32_t hash(const char* str) {
+      uint32_t h = 2166136261u;               // FNV-1a
+      while (*str) {
+        h ^= static_cast<uint8_t>(*str++);
+        h *= 16777619u;
+      }
+      return h;
+    }
+
+    // drops all entries and makes room for at least `count` names without growing
+    bool reserve(size_t count) {
+      size_t newCapacity = 8;
+      while (newCapacity < count + count / 2 + 1) newCapacity <<= 1;
+      if (newCapacity > MaxCapacity) return false;
+      if (newCapacity != capacity) {
+        delete[] entries;
+        entries = new (std::nothrow) Entry[newCapacity];
+        if (entries == nullptr) {
+          capacity = 0;
+          size = 0;
+          return false;
+        }
+        capacity = static_cast<uint16_t>(newCapacity);
+      }
+      clear();
+      return true;
+    }
+
+    bool needsGrow() const {return (static_cast<size_t>(size) + 1) * 4 > static_cast<size_t>(capacity) * 3;}
+    size_t count() const {return size;}
+
+    void insert(const char* name, uint16_t slot) {
+      uint32_t h = hash(name);
+      uint16_t mask = capacity - 1;
+      uint16_t pos = h & mask;
+      while (entries[pos].slot != EmptySlot) pos = (pos + 1) & mask;
+      entries[pos].slot = slot;
+      entries[pos].tag = tagOf(h);
+      size++;
+    }
+
+    template <typename NameOf>
+    int32_t find(const char* name, NameOf nameOf) const {
+      if (name == nullptr || capacity == 0) return -1;
+      uint32_t h = hash(name);
+      uint16_t tag = tagOf(h);
+      uint16_t mask = capacity - 1;
+      for (uint16_t pos = h & mask; entries[pos].slot != EmptySlot; pos = (pos + 1) & mask) {
+        if (entries[pos].tag == tag && !strcmp(nameOf(entries[pos].slot), name)) return entries[pos].slot;
+      }
+      return -1;
+    }
+
+    void clear() {
+      for (uint16_t i = 0; i < capacity; i++) entries[i].slot = EmptySlot;
+      size = 0;
+    }
+
+  private:
+    struct Entry {
+      uint16_t slot;
+      uint16_t tag;
+    };
+    static uint16_t tagOf(uint32_t h) {return static_cast<uint16_t>(h >> 16);}
+    Entry* entries = nullptr;
+    uint16_t capacity = 0;
+    uint16_t size = 0;
+  };
+
+  // Immutable layout strings - component names, colors, text colors, button texts - stored once in the arena.
+  // Every distinct string has a 16-bit handle, its position in the pool. Equal strings share the pointer and the handle,
+  // so comparing two pooled strings is an integer compare; only a string from outside (a /status message) is hashed and compared once.
+  class StringPool {
+  public:
+    explicit StringPool(Arena& arena) : arena(arena) {}
+    StringPool(const StringPool&) = delete;
+    StringPool& operator=(const StringPool&) = delete;
+
+    // handle of str, which is pooled first when it is new; -1 when out of memory or the pool is full
+    int32_t add(const char* str);
+    // handle of str when it is pooled, -1 otherwise
+    int32_t find(const char* str) const {return str != nullptr ? index.find(str, [this] (uint16_t i) {return this->strings[i];}) : -1;}
+    const char* at(uint16_t handle) const {return strings[handle];}
+    // pooled copy of str; a full pool only stops sharing, the string is still kept
+    const char* intern(const char* str) {
+      int32_t handle = add(str);
+      if(handle >= 0) return strings[handle];
+      return str == nullptr || isBorrowed(str) ? str : arena.copy(str);
+    }
+    // room for `count` more strings without growing
+    bool reserve(size_t count) {
+      strings.reserve(strings.size() + count);
+      return this->grow((strings.size() + count) * 2);
+    }
+    // JSON keys whose values components intern, Card::reserve() sizes the arena with it
+    static bool isPooled(const char* key) {
+      return !strcmp(key, JsonKey::Color) || !strcmp(key, JsonKey::TextColor) || !strcmp(key, JsonKey::Text)
+          || !strcmp(key, JsonKey::FieldOutlineColor);
+    }
+    // forgets strings pooled after mark(), used together with Arena::rollback()
+    size_t mark() const {return strings.size();}
+    void rollback(size_t marker) {
+      if(marker >= strings.size()) return;
+      strings.resize(marker);
+      this->grow(strings.size() * 2 + 8);
+    }
+    void clear() {
+      strings.clear();
+      index.clear();
+      shared = 0;
+      borrowedBegin = borrowedEnd = nullptr;
+    }
+    // strings inside [begin, begin + length) outlive the pool, add() and intern() reference them instead of copying
+    void borrow(const char* begin, size_t length) {
+      borrowedBegin = begin;
+      borrowedEnd = begin + length;
+    }
+    bool isBorrowed(const char* str) const {return str >= borrowedBegin && str < borrowedEnd;}
+    size_t size() const {return strings.size();}
+    uint32_t sharedCount() const {return shared;}     // add() calls answered with an existing string
+  private:
+    bool grow(size_t count);
+    Arena& arena;
+    ComponentIndex index;
+    std::vector<const char*> strings;
+    uint32_t shared = 0;
+    const char* borrowedBegin = nullptr;
+    const char* borrowedEnd = nullptr;
+  };
+
+  int32_t StringPool::add(const char* str) {
+    int32_t handle = find(str);
+    if(handle >= 0) {
+      shared++;
+      return handle;
+    }
+    if(str == nullptr || strings.size() >= ComponentIndex::MaxComponents) return -1;
+    if(index.needsGrow() && !this->grow(strings.size() * 2 + 8)) return -1;
+    const char* pooled = isBorrowed(str) ? str : arena.copy(str);
+    if(pooled == nullptr) return -1;
+    index.insert(pooled, static_cast<uint16_t>(strings.size()));
+    strings.push_back(pooled);
+    return static_cast<int32_t>(strings.size() - 1);
+  }
+
+  bool StringPool::grow(size_t count) {
+    if(!index.reserve(std::min<size_t>(count, ComponentIndex::MaxComponents))) return false;
+    for(size_t i = 0; i < strings.size(); i++) index.insert(strings[i], static_cast<uint16_t>(i));
+    return true;
+  }
+
+  // A color of an output component, which setState() changes. A value the pool holds is shared, another one gets its own copy:
+  // the pool is only looked up here, so values arriving at runtime never grow the arena.
+  class SharedString {
+  public:
+    SharedString(const char* pooled = "") : pooled(pooled) {}
+    const char* c_str() const {return pooled != nullptr ? pooled : own.c_str();}
+    // returns true when the value changed
+    bool set(const char* value, const StringPool& pool) {
+      if(value == nullptr) value = "";
+      if(!strcmp(c_str(), value)) return false;
+      int32_t handle = pool.find(value);
+      if(handle >= 0) {
+        pooled = pool.at(static_cast<uint16_t>(handle));
+        own = String();
+      } else {
+        own = value;
+        pooled = nullptr;
+      }
+      return true;
+    }
+  private:
+    const char* pooled;
+    String own;
+  };
+
   class WebsiteComponent {
   public:
-    explicit WebsiteComponent(const JsonObjectConst& inputObject);
+    WebsiteComponent(const JsonObjectConst& inputObject, StringPool& strings);
     virtual ~WebsiteComponent() = default;
 
       // ** THIS METHOD USES COMMON MEMORY(DOCUMENT) FOR STORING JSON TO AVOID MULTIPLE HEAP ALLOCATIONS **
       // ** WHEN YOU GET OBJECT, THE PREVIOUS ONE IS DELETED AUTOMATICALLY **
-      // ** REMEMBER TO CHECK THAT MEMORY IS NOT LOCKED ADN WRAP THIS METHOD IN lock() and release() functions to make it thread safe (ESP32)
+      // ** HOLD A CommonJsonMemory::Guard ON getJsonMemory() WHILE USING THE OBJECT TO MAKE IT THREAD SAFE (ESP32)
     virtual JsonObject toWebsiteJson() = 0;
-    virtual void setState(const JsonObjectConst& object) = 0;
+    // Final classes split toWebsiteJson() into addStaticFields(), fixed after load, and addDynamicFields(), what setState() changes.
+    // Card serializes the static part once at load, /input copies it and serializes only the dynamic fields.
+    virtual void addDynamicFields(JsonObject& object) const = 0;
+    const char* getStaticJson() const {return staticJson;}
+    uint16_t getStaticJsonLength() const {return staticJsonLength;}
+    void setStaticJson(const char* json, uint16_t length) {
+      staticJson = json;
+      staticJsonLength = length;
+    }
+    virtual bool setState(const JsonObjectConst& object) = 0;    // returns true when the state really changed
+    virtual InputComponent* asInput() {return nullptr;}
+    virtual OutputComponent* asOutput() {return nullptr;}
     bool isInitializedOK() const {return initializedOK;}
-    const String& getName() const  {return name;}
+    const char* getName() const  {return name;}
+    uint16_t getNameHandle() const {return nameHandle;}            // equal names, equal handles within one card
+    uint16_t getId() const {return id;}
+    void setId(uint16_t nId) {id = nId;}
+    uint32_t getChangedVersion() const {return changedVersion;}
+    void setChangedVersion(uint32_t version) {changedVersion = version;}
 
     static void setJsonMemory (CommonJsonMemory* mem);
-    static void lockJsonMemory();
-    static void releaseJsonMemory();
-    static bool isMemoryReadyToUse();
+    static CommonJsonMemory* getJsonMemory() {return jsonMemory;}
   protected:
+    // assigns only when the value differs, so setState() can tell a real change from a repeated update
+    template <typename fieldType, typename valueType> static bool update(fieldType& field, const valueType& value) {
+      if(field == value) return false;
+      field = value;
+      return true;
+    }
     static CommonJsonMemory* jsonMemory;
+    uint32_t changedVersion = 0;
+    const char* staticJson = nullptr;                          // "{...static fields" without the closing brace, in the card's arena
+    uint16_t staticJsonLength = 0;
+    uint16_t id = 0;                                            // position in the layout, identifies the component on the binary Visuino link
     bool initializedOK;
     uint16_t posX;
     uint16_t posY;
-    String name;
+    const char* name;                                           // immutable strings are kept in the card's arena, shared ones in its StringPool
+    uint16_t nameHandle = 0;
   };
   CommonJsonMemory* WebsiteComponent::jsonMemory = nullptr;
 
-  WebsiteComponent::WebsiteComponent(const JsonObjectConst& inputObject){
+  WebsiteComponent::WebsiteComponent(const JsonObjectConst& inputObject, StringPool& strings){
     initializedOK = true;
     if(inputObject.containsKey(JsonKey::Name)) {
-      this->name = inputObject[JsonKey::Name].as<const char*>();
+      int32_t handle = strings.add(inputObject[JsonKey::Name].as<const char*>());
+      this->nameHandle = handle >= 0 ? static_cast<uint16_t>(handle) : 0;
+      this->name = handle >= 0 ? strings.at(this->nameHandle) : "";
+      if(handle < 0) initializedOK = false;
     } else {
+      this->name = "";
       Log::error("Name not found");
       initializedOK = false;
     }
@@ -259,18 +1089,6 @@ namespace Website {
     }
   }
 
-  void WebsiteComponent::lockJsonMemory() {
-    if(jsonMemory != nullptr) jsonMemory->lock();
-  }
-
-  void WebsiteComponent::releaseJsonMemory() {
-    if(jsonMemory != nullptr) jsonMemory->unlock();
-  }
-
-  bool WebsiteComponent::isMemoryReadyToUse() {
-    if(jsonMemory != nullptr) return jsonMemory->isReadyToUse();
-    else return false;
-  }
 
   // ----------------------------------------------------------------------------
   //                         COMPONENTS CLASSES
@@ -279,25 +1097,41 @@ namespace Website {
 
   class InputComponent : public WebsiteComponent {
   public:
-    explicit InputComponent(const JsonObjectConst& inputObject)
-      : WebsiteComponent(inputObject) {
+    InputComponent(const JsonObjectConst& inputObject, StringPool& strings)
+      : WebsiteComponent(inputObject, strings) {
+    }
+    virtual Visuino::Event toVisuinoEvent() const = 0;
+    InputComponent* asInput() override {return this;}
+    bool isVisuinoPending() const {return visuinoPending;}
+    void setVisuinoPending(bool pending) {
+      visuinoPending = pending;
+      if(pending) pendingSince = micros();
     }
-    virtual JsonObject toVisuinoJson() = 0; //using common memory
+    uint32_t getPendingSince() const {return pendingSince;}
+    Visuino::OverflowSlot& getOverflowSlot() {return overflow;}
   private:
+    Visuino::OverflowSlot overflow;
+    uint32_t pendingSince = 0;
+    bool visuinoPending = false;                                // queued in Card::pendingInputs, waiting for loop() to forward it
   };
 
   class OutputComponent : public WebsiteComponent {
   public:
-    explicit OutputComponent(const JsonObjectConst& inputObject)
-      : WebsiteComponent(inputObject){}
+    OutputComponent(const JsonObjectConst& inputObject, StringPool& strings)
+      : WebsiteComponent(inputObject, strings), pool(strings) {}
+    OutputComponent* asOutput() override {return this;}
+    // only the fields setState() can change, pushed to /events clients - uses common memory like toWebsiteJson()
+    virtual JsonObject toStateJson() = 0;
+  protected:
+    const StringPool& pool;                                     // the card's, setState() shares the colors it already holds
   };
 
 
 
-  class Switch : public InputComponent {
+  class Switch final : public InputComponent {
   public:
-    explicit Switch(const JsonObjectConst& inputObject)
-            : InputComponent(inputObject){
+    Switch(const JsonObjectConst& inputObject, StringPool& strings)
+            : InputComponent(inputObject, strings){
       if(inputObject.containsKey(JsonKey::Value)){
         this->value = inputObject[JsonKey::Value];
       } else {
@@ -308,50 +1142,46 @@ namespace Website {
       } else this->size = 10;
     }
 
-    JsonObject toVisuinoJson() override {
-      JsonObject outputObj = jsonMemory->get()->to<JsonObject>();
-      outputObj[JsonKey::Name] = this->name;
-      outputObj[JsonKey::Value] = this->value;
-      return outputObj;
+    Visuino::Event toVisuinoEvent() const override {
+      return Visuino::Event {this->id, Visuino::TypeTag::SWITCH, this->value ? 1u : 0u};
+    }
+
+    void addStaticFields(JsonObject& object) const {
+      object[JsonKey::Name] = this->name;
+      object[JsonKey::PosX] = this->posX;
+      object[JsonKey::PosY] = this->posY;
+      object[JsonKey::Size] = this->size;
+      object[JsonKey::ComponentType] = ComponentType::Input::Switch;
+    }
+
+    void addDynamicFields(JsonObject& object) const override {
+      object[JsonKey::Value] = this->value;
     }
 
     JsonObject toWebsiteJson() override {
       JsonObject websiteObj = jsonMemory->get()->to<JsonObject>();
-      websiteObj[JsonKey::Name] = this->name;
-      websiteObj[JsonKey::PosX] = this->posX;
-      websiteObj[JsonKey::PosY] = this->posY;
-      websiteObj[JsonKey::Value] = this->value;
-      websiteObj[JsonKey::Size] = this->size;
-      websiteObj[JsonKey::ComponentType] = ComponentType::Input::Switch;
+      addStaticFields(websiteObj);
+      addDynamicFields(websiteObj);
       return websiteObj;
     }
 
-    void setState(const JsonObjectConst& object) override {
+    bool setState(const JsonObjectConst& object) override {
       if(object.containsKey(JsonKey::Value)){
-        this->value = object[JsonKey::Value];
+        return update(this->value, object[JsonKey::Value].as<bool>());
       }
+      return false;
     }
 
-    static void setVisuinoOutput(const JsonObjectConst& obj) {
-      str.clear();
-      serializeJson(obj, str);
-      isDataReady = true;
-    }
-    static const String& getVisuinoOutput() {return str;}
-    static bool isDataReady;
   private:
-    static String str;
     bool value;
     uint16_t size;
   };
 
-  String Switch::str;
-  bool Switch::isDataReady = false;
 
-  class Slider : public InputComponent {
+  class Slider final : public InputComponent {
   public:
-    explicit Slider(const JsonObjectConst& inputObject)
-      : InputComponent(inputObject) {
+    Slider(const JsonObjectConst& inputObject, StringPool& strings)
+      : InputComponent(inputObject, strings) {
       if(inputObject.containsKey(JsonKey::Width)){
         this->width = inputObject[JsonKey::Width];
       } else this->width = DefaultValues::Width;
@@ -368,62 +1198,58 @@ namespace Website {
         this->value = inputObject[JsonKey::Value];
       } else this->value = 0;
       if(inputObject.containsKey(JsonKey::Color)){
-        this->color = inputObject[JsonKey::Color].as<const char*>();
+        this->color = strings.intern(inputObject[JsonKey::Color].as<const char*>());
       } else this->color = DefaultValues::Color;
     }
 
-    JsonObject toVisuinoJson() override {
-      JsonObject outputObj = jsonMemory->get()->to<JsonObject>();
-      outputObj[JsonKey::Name] = this->name;
-      outputObj[JsonKey::Value] = this->value;
-      return outputObj;
+    Visuino::Event toVisuinoEvent() const override {
+      return Visuino::Event {this->id, Visuino::TypeTag::SLIDER, this->value};
+    }
+
+    void addStaticFields(JsonObject& object) const {
+      object[JsonKey::Name] = this->name;
+      object[JsonKey::PosX] = this->posX;
+      object[JsonKey::PosY] = this->posY;
+      object[JsonKey::MaxValue] = this->maxValue;
+      object[JsonKey::MinValue] = this->minValue;
+      object[JsonKey::Width] = this->width;
+      object[JsonKey::Height] = this->height;
+      object[JsonKey::Color] = this->color;
+      object[JsonKey::ComponentType] = ComponentType::Input::Slider;
+    }
+
+    void addDynamicFields(JsonObject& object) const override {
+      object[JsonKey::Value] = this->value;
     }
 
     JsonObject toWebsiteJson() override {
       JsonObject websiteObj = jsonMemory->get()->to<JsonObject>();
-      websiteObj[JsonKey::Name] = this->name;
-      websiteObj[JsonKey::PosX] = this->posX;
-      websiteObj[JsonKey::PosY] = this->posY;
-      websiteObj[JsonKey::Value] = this->value;
-      websiteObj[JsonKey::MaxValue] = this->maxValue;
-      websiteObj[JsonKey::MinValue] = this->minValue;
-      websiteObj[JsonKey::Width] = this->width;
-      websiteObj[JsonKey::Height] = this->height;
-      websiteObj[JsonKey::Color] = this->color;
-      websiteObj[JsonKey::ComponentType] = ComponentType::Input::Slider;
+      addStaticFields(websiteObj);
+      addDynamicFields(websiteObj);
       return websiteObj;
     }
 
-    void setState(const JsonObjectConst& object) override {
+    bool setState(const JsonObjectConst& object) override {
       if(object.containsKey(JsonKey::Value)){
-        this->value = object[JsonKey::Value];
+        return update(this->value, object[JsonKey::Value].as<uint32_t>());
       }
+      return false;
     }
 
-    static void setVisuinoOutput(const JsonObjectConst& obj) {
-      str.clear();
-      serializeJson(obj, str);
-      isDataReady = true;
-    }
-    static const String& getVisuinoOutput() {return str;}
-    static bool isDataReady;
   private:
-    static String str;
-    String color;
+    const char* color;
     uint16_t width;
     uint16_t height;
     uint32_t value;
     uint32_t minValue;
     uint32_t maxValue;
   };
-  String Slider::str;
-  bool Slider::isDataReady;
 
 
-  class NumberInput : public InputComponent {
+  class NumberInput final : public InputComponent {
   public:
-    explicit NumberInput(const JsonObjectConst& inputObject)
-      : InputComponent(inputObject) {
+    NumberInput(const JsonObjectConst& inputObject, StringPool& strings)
+      : InputComponent(inputObject, strings) {
       if (inputObject.containsKey(JsonKey::Value)){
         this->value = inputObject[JsonKey::Value];
       } else this->value = 0.0f;
@@ -434,60 +1260,55 @@ namespace Website {
         this->width = inputObject[JsonKey::Width];
       } else this->width = DefaultValues::Width;
       if(inputObject.containsKey(JsonKey::Color)){
-        this->color = inputObject[JsonKey::Color].as<const char*>();
+        this->color = strings.intern(inputObject[JsonKey::Color].as<const char*>());
       } else this->color = DefaultValues::Color;
     }
 
-    JsonObject toVisuinoJson() override {
-      JsonObject outputObj = jsonMemory->get()->to<JsonObject>();
-      outputObj[JsonKey::Name] = this->name;
-      outputObj[JsonKey::Value] = this->value;
-      return outputObj;
+    Visuino::Event toVisuinoEvent() const override {
+      return Visuino::Event {this->id, Visuino::TypeTag::NUMBER_INPUT, Visuino::packFloat(this->value)};
+    }
+
+
+    void addStaticFields(JsonObject& object) const {
+      object[JsonKey::Name] = this->name;
+      object[JsonKey::PosX] = this->posX;
+      object[JsonKey::PosY] = this->posY;
+      object[JsonKey::Width] = this->width;
+      object[JsonKey::Color] = this->color;
+      object[JsonKey::ComponentType] = ComponentType::Input::NumberInput;
     }
 
+    void addDynamicFields(JsonObject& object) const override {
+      object[JsonKey::Value] = this->value;
+    }
 
     JsonObject toWebsiteJson() override {
       JsonObject websiteObj = jsonMemory->get()->to<JsonObject>();
-      websiteObj[JsonKey::Name] = this->name;
-      websiteObj[JsonKey::PosX] = this->posX;
-      websiteObj[JsonKey::PosY] = this->posY;
-      websiteObj[JsonKey::Value] = this->value;
-      websiteObj[JsonKey::Width] = this->width;
-      websiteObj[JsonKey::Color] = this->color;
-      websiteObj[JsonKey::ComponentType] = ComponentType::Input::NumberInput;
+      addStaticFields(websiteObj);
+      addDynamicFields(websiteObj);
       return websiteObj;
     }
 
-    void setState(const JsonObjectConst& object) override {
+    bool setState(const JsonObjectConst& object) override {
       if(object.containsKey(JsonKey::Value)){
-        this->value = object[JsonKey::Value];
+        return update(this->value, object[JsonKey::Value].as<float>());
       }
+      return false;
     }
 
-    static void setVisuinoOutput(const JsonObjectConst& obj) {
-      str.clear();
-      serializeJson(obj, str);
-      isDataReady = true;
-    }
-    static const String& getVisuinoOutput() {return str;}
-    static bool isDataReady;
-
   private:
-    static String str;
     float value;
     uint16_t width;
     uint16_t fontSize;
-    String color;
+    const char* color;
   };
 
-  String NumberInput::str;
-  bool NumberInput::isDataReady;
 
 
-  class Button : public InputComponent {
+  class Button final : public InputComponent {
   public:
-    explicit Button(const JsonObjectConst& inputObject)
-      : InputComponent(inputObject){
+    Button(const JsonObjectConst& inputObject, StringPool& strings)
+      : InputComponent(inputObject, strings){
       if(inputObject.containsKey(JsonKey::Width)){
         this->width = inputObject[JsonKey::Width];
       } else initializedOK = false;
@@ -498,13 +1319,13 @@ namespace Website {
         this->fontSize = inputObject[JsonKey::FontSize];
       } else this->fontSize = DefaultValues::FontSize;
       if(inputObject.containsKey(JsonKey::Text)){
-        this->text = inputObject[JsonKey::Text].as<const char*>();
+        this->text = strings.intern(inputObject[JsonKey::Text].as<const char*>());
       } else initializedOK = false;
       if(inputObject.containsKey(JsonKey::Color)){
-        this->color = inputObject[JsonKey::Color].as<const char*>();
+        this->color = strings.intern(inputObject[JsonKey::Color].as<const char*>());
       } else this->color = DefaultValues::Color;
       if(inputObject.containsKey(JsonKey::TextColor)){
-        this->textColor = inputObject[JsonKey::TextColor].as<const char*>();
+        this->textColor = strings.intern(inputObject[JsonKey::TextColor].as<const char*>());
       } else this->textColor = DefaultValues::TextColor;
       if(inputObject.containsKey(JsonKey::IsVertical)){
         this->isVertical = inputObject[JsonKey::IsVertical];
@@ -512,109 +1333,118 @@ namespace Website {
       this->value = false;
     }
 
-    JsonObject toVisuinoJson() override {
-      JsonObject outputObj = jsonMemory->get()->to<JsonObject>();
-      outputObj[JsonKey::Name] = this->name;
-      outputObj[JsonKey::Value] = this->value;
-      return outputObj;
+    Visuino::Event toVisuinoEvent() const override {
+      return Visuino::Event {this->id, Visuino::TypeTag::BUTTON, this->value ? 1u : 0u};
+    }
+
+    void addStaticFields(JsonObject& object) const {
+      object[JsonKey::Name] = this->name;
+      object[JsonKey::PosX] = this->posX;
+      object[JsonKey::PosY] = this->posY;
+      object[JsonKey::Width] = this->width;
+      object[JsonKey::Height] = this->height;
+      object[JsonKey::Color] = this->color;
+      object[JsonKey::TextColor] = this->textColor;
+      object[JsonKey::Text] = this->text;
+      object[JsonKey::FontSize] = this->fontSize;
+      object[JsonKey::IsVertical] = this->isVertical;
+      object[JsonKey::ComponentType] = ComponentType::Input::Button;
     }
 
+    void addDynamicFields(JsonObject&) const override {}
+
     JsonObject toWebsiteJson() override {
       JsonObject websiteObj = jsonMemory->get()->to<JsonObject>();
-      websiteObj[JsonKey::Name] = this->name;
-      websiteObj[JsonKey::PosX] = this->posX;
-      websiteObj[JsonKey::PosY] = this->posY;
-      websiteObj[JsonKey::Width] = this->width;
-      websiteObj[JsonKey::Height] = this->height;
-      websiteObj[JsonKey::Color] = this->color;
-      websiteObj[JsonKey::TextColor] = this->textColor;
-      websiteObj[JsonKey::Text] = this->text;
-      websiteObj[JsonKey::FontSize] = this->fontSize;
-      websiteObj[JsonKey::IsVertical] = this->isVertical;
-      websiteObj[JsonKey::ComponentType] = ComponentType::Input::Button;
+      addStaticFields(websiteObj);
+      addDynamicFields(websiteObj);
       return websiteObj;
     }
-    void setState(const JsonObjectConst& object) override {
+    bool setState(const JsonObjectConst& object) override {
       if(object.containsKey(JsonKey::Value))
-        this->value = object[JsonKey::Value];
-    }
-
-    static void setVisuinoOutput(const JsonObjectConst& obj) {
-      str.clear();
-      serializeJson(obj, str);
-      isDataReady = true;
+        return update(this->value, object[JsonKey::Value].as<bool>());
+      return false;
     }
 
-    static const String& getVisuinoOutput() {return str;}
-    static bool isDataReady;
-
-
   private:
-    static String str;
     bool value;
     uint16_t width;
     uint16_t height;
     uint16_t fontSize;
-    String text;
-    String color;
-    String textColor;
+    const char* text;
+    const char* color;
+    const char* textColor;
     bool isVertical;
   };
-  String Button::str;
-  bool Button::isDataReady;
 
 
-  class Label : public OutputComponent {
+  class Label final : public OutputComponent {
   public:
-    explicit Label(const JsonObjectConst& inputObject)
-    : OutputComponent(inputObject) {
+    Label(const JsonObjectConst& inputObject, StringPool& strings)
+    : OutputComponent(inputObject, strings) {
       if(inputObject.containsKey(JsonKey::FontSize)){
         this->fontSize = inputObject[JsonKey::FontSize];
       } else fontSize = DefaultValues::FontSize;
       if(inputObject.containsKey(JsonKey::Color)){
-        this->color = inputObject[JsonKey::Color].as<const char*>();
+        this->color = strings.intern(inputObject[JsonKey::Color].as<const char*>());
       } else this->color = DefaultValues::Color;
       if(inputObject.containsKey(JsonKey::Value)){
         this->value = inputObject[JsonKey::Value].as<const char*>();
       } else this->value = "";
     }
 
+    void addStaticFields(JsonObject& object) const {
+      object[JsonKey::Name] = this->name;
+      object[JsonKey::PosX] = this->posX;
+      object[JsonKey::PosY] = this->posY;
+      object[JsonKey::ComponentType] = ComponentType::Output::Label;
+    }
+
+    void addDynamicFields(JsonObject& object) const override {
+      object[JsonKey::Value] = this->value.c_str();
+      object[JsonKey::Color] = this->color.c_str();
+      object[JsonKey::FontSize] = this->fontSize;
+    }
+
     JsonObject toWebsiteJson() override {
       JsonObject websiteObj = jsonMemory->get()->to<JsonObject>();
-      websiteObj[JsonKey::Name] = this->name;
-      websiteObj[JsonKey::PosX] = this->posX;
-      websiteObj[JsonKey::PosY] = this->posY;
-      websiteObj[JsonKey::Value] = this->value;
-      websiteObj[JsonKey::Color] = this->color;
-      websiteObj[JsonKey::FontSize] = this->fontSize;
-      websiteObj[JsonKey::ComponentType] = ComponentType::Output::Label;
+      addStaticFields(websiteObj);
+      addDynamicFields(websiteObj);
       return websiteObj;
     }
 
-    void setState(const JsonObjectConst& object) override {
+    JsonObject toStateJson() override {
+      JsonObject stateObj = jsonMemory->get()->to<JsonObject>();
+      stateObj[JsonKey::Name] = this->name;
+      addDynamicFields(stateObj);
+      return stateObj;
+    }
+
+    bool setState(const JsonObjectConst& object) override {
+      bool changed = false;
       if(object.containsKey(JsonKey::FontSize)){
-        this->fontSize = object[JsonKey::FontSize];
+        changed |= update(this->fontSize, object[JsonKey::FontSize].as<uint16_t>());
       }
       if(object.containsKey(JsonKey::Color)){
-        this->color = object[JsonKey::Color].as<const char*>();
+        changed |= this->color.set(object[JsonKey::Color].as<const char*>(), pool);
       }
       if(object.containsKey(JsonKey::Value)){
-        this->value = object[JsonKey::Value].as<const char*>();
+        changed |= update(this->value, object[JsonKey::Value].as<const char*>());
       }
+      return changed;
     }
 
   private:
     uint16_t fontSize;
-    String color;
+    SharedString color;
     String value;
   };
 
 
 
-  class Gauge : public OutputComponent{
+  class Gauge final : public OutputComponent {
   public:
-    explicit Gauge(const JsonObjectConst& inputObject)
-      : OutputComponent(inputObject){
+    Gauge(const JsonObjectConst& inputObject, StringPool& strings)
+      : OutputComponent(inputObject, strings){
       if(inputObject.containsKey(JsonKey::MaxValue)){
         this->maxValue = inputObject[JsonKey::MaxValue];
       } else {
@@ -631,7 +1461,7 @@ namespace Website {
         this->value = inputObject[JsonKey::Value];
       } else this->value = 0;
       if(inputObject.containsKey(JsonKey::Color)){
-        this->color = inputObject[JsonKey::Color].as<const char*>();
+        this->color = strings.intern(inputObject[JsonKey::Color].as<const char*>());
       } else this->color = DefaultValues::Color;
       if(inputObject.containsKey(JsonKey::Width)){
         this->width = inputObject[JsonKey::Width];
@@ -641,28 +1471,45 @@ namespace Website {
       } else this->height = DefaultValues::Height;
     }
 
-    JsonObject toWebsiteJson() override{
+    void addStaticFields(JsonObject& object) const {
+      object[JsonKey::Name] = this->name;
+      object[JsonKey::PosX] = this->posX;
+      object[JsonKey::PosY] = this->posY;
+      object[JsonKey::MaxValue] = this->maxValue;
+      object[JsonKey::MinValue] = this->minValue;
+      object[JsonKey::Width] = this->width;
+      object[JsonKey::Height] = this->height;
+      object[JsonKey::ComponentType] = ComponentType::Output::Gauge;
+    }
+
+    void addDynamicFields(JsonObject& object) const override {
+      object[JsonKey::Value] = this->value;
+      object[JsonKey::Color] = this->color.c_str();
+    }
+
+    JsonObject toWebsiteJson() override {
       JsonObject websiteObj = jsonMemory->get()->to<JsonObject>();
-      websiteObj[JsonKey::Name] = this->name;
-      websiteObj[JsonKey::PosX] = this->posX;
-      websiteObj[JsonKey::PosY] = this->posY;
-      websiteObj[JsonKey::Value] = this->value;
-      websiteObj[JsonKey::MaxValue] = this->maxValue;
-      websiteObj[JsonKey::MinValue] = this->minValue;
-      websiteObj[JsonKey::Width] = this->width;
-      websiteObj[JsonKey::Height] = this->height;
-      websiteObj[JsonKey::Color] = this->color;
-      websiteObj[JsonKey::ComponentType] = ComponentType::Output::Gauge;
+      addStaticFields(websiteObj);
+      addDynamicFields(websiteObj);
       return websiteObj;
     }
 
-    void setState(const JsonObjectConst& object) override{
+    JsonObject toStateJson() override {
+      JsonObject stateObj = jsonMemory->get()->to<JsonObject>();
+      stateObj[JsonKey::Name] = this->name;
+      addDynamicFields(stateObj);
+      return stateObj;
+    }
+
+    bool setState(const JsonObjectConst& object) override{
+      bool changed = false;
       if(object.containsKey(JsonKey::Value)){
-        this->value = object[JsonKey::Value];
-      } else this->value = 0;
+        changed |= update(this->value, object[JsonKey::Value].as<uint32_t>());
+      } else changed |= update(this->value, 0u);
       if(object.containsKey(JsonKey::Color)){
-        this->color = object[JsonKey::Color].as<const char*>();
-      } else this->color = DefaultValues::Color;
+        changed |= this->color.set(object[JsonKey::Color].as<const char*>(), pool);
+      } else changed |= this->color.set(DefaultValues::Color, pool);
+      return changed;
     }
 
   private:
@@ -671,13 +1518,13 @@ namespace Website {
     uint32_t maxValue;
     uint16_t width;
     uint16_t height;
-    String color;
+    SharedString color;
   };
 
-  class LedIndicator : public OutputComponent {
+  class LedIndicator final : public OutputComponent {
   public:
-    explicit LedIndicator(const JsonObjectConst& inputObject)
-      : OutputComponent(inputObject){
+    LedIndicator(const JsonObjectConst& inputObject, StringPool& strings)
+      : OutputComponent(inputObject, strings){
       if(inputObject.containsKey(JsonKey::Value)){
         this->value = inputObject[JsonKey::Value];
       } else this->value = DefaultValues::BooleanValue;
@@ -685,42 +1532,59 @@ namespace Website {
         this->size = inputObject[JsonKey::Size];
       } else this->size = 10;
       if(inputObject.containsKey(JsonKey::Color)){
-        this->color = inputObject[JsonKey::Color].as<const char*>();
+        this->color = strings.intern(inputObject[JsonKey::Color].as<const char*>());
       } else this->color = DefaultValues::LedColor;
     }
 
-    JsonObject toWebsiteJson() override{
+    void addStaticFields(JsonObject& object) const {
+      object[JsonKey::Name] = this->name;
+      object[JsonKey::PosX] = this->posX;
+      object[JsonKey::PosY] = this->posY;
+      object[JsonKey::Size] = this->size;
+      object[JsonKey::ComponentType] = ComponentType::Output::Indicator;
+    }
+
+    void addDynamicFields(JsonObject& object) const override {
+      object[JsonKey::Value] = this->value;
+      object[JsonKey::Color] = this->color.c_str();
+    }
+
+    JsonObject toWebsiteJson() override {
       JsonObject websiteObj = jsonMemory->get()->to<JsonObject>();
-      websiteObj[JsonKey::Name] = this->name;
-      websiteObj[JsonKey::PosX] = this->posX;
-      websiteObj[JsonKey::PosY] = this->posY;
-      websiteObj[JsonKey::Value] = this->value;
-      websiteObj[JsonKey::Color] = this->color;
-      websiteObj[JsonKey::Size] = this->size;
-      websiteObj[JsonKey::ComponentType] = ComponentType::Output::Indicator;
+      addStaticFields(websiteObj);
+      addDynamicFields(websiteObj);
       return websiteObj;
     }
 
-    void setState(const JsonObjectConst& object) override{
+    JsonObject toStateJson() override {
+      JsonObject stateObj = jsonMemory->get()->to<JsonObject>();
+      stateObj[JsonKey::Name] = this->name;
+      addDynamicFields(stateObj);
+      return stateObj;
+    }
+
+    bool setState(const JsonObjectConst& object) override{
+      bool changed = false;
       if(object.containsKey(JsonKey::Value)){
-        this->value = object[JsonKey::Value];
+        changed |= update(this->value, object[JsonKey::Value].as<bool>());
       }
       if(object.containsKey(JsonKey::Color)){
-        this->color = object[JsonKey::Color].as<const char*>();
+        changed |= this->color.set(object[JsonKey::Color].as<const char*>(), pool);
       }
+      return changed;
     }
 
   private:
     bool value;
     uint16_t size;
-    String color;
+    SharedString color;
   };
 
 
-  class ProgressBar : public OutputComponent{
+  class ProgressBar final : public OutputComponent {
   public:
-    explicit ProgressBar(const JsonObjectConst& inputObject)
-      : OutputComponent(inputObject) {
+    ProgressBar(const JsonObjectConst& inputObject, StringPool& strings)
+      : OutputComponent(inputObject, strings) {
       if(inputObject.containsKey(JsonKey::MinValue)) {
         this->minValue = inputObject[JsonKey::MinValue];
       } else initializedOK = false;
@@ -731,7 +1595,7 @@ namespace Website {
         this->value = inputObject[JsonKey::Value];
       } else this->value = 0;
       if(inputObject.containsKey(JsonKey::Color)) {
-        this->color = inputObject[JsonKey::Color].as<const char*>();
+        this->color = strings.intern(inputObject[JsonKey::Color].as<const char*>());
       } else this->color = DefaultValues::Color2;
       if(inputObject.containsKey(JsonKey::Width)) {
         this->width = inputObject[JsonKey::Width];
@@ -745,33 +1609,49 @@ namespace Website {
     }
 
 
+    void addStaticFields(JsonObject& object) const {
+      object[JsonKey::Name] = this->name;
+      object[JsonKey::PosX] = this->posX;
+      object[JsonKey::PosY] = this->posY;
+      object[JsonKey::Width] = this->width;
+      object[JsonKey::Height] = this->height;
+      object[JsonKey::MaxValue] = this->maxValue;
+      object[JsonKey::MinValue] = this->minValue;
+      object[JsonKey::IsVertical] = this->isVertical;
+      object[JsonKey::ComponentType] = ComponentType::Output::ProgressBar;
+    }
+
+    void addDynamicFields(JsonObject& object) const override {
+      object[JsonKey::Value] = this->value;
+      object[JsonKey::Color] = this->color.c_str();
+    }
+
     JsonObject toWebsiteJson() override {
       JsonObject websiteObj = jsonMemory->get()->to<JsonObject>();
-      websiteObj[JsonKey::Name] = this->name;
-      websiteObj[JsonKey::PosX] = this->posX;
-      websiteObj[JsonKey::PosY] = this->posY;
-      websiteObj[JsonKey::Width] = this->width;
-      websiteObj[JsonKey::Height] = this->height;
-      websiteObj[JsonKey::Value] = this->value;
-      websiteObj[JsonKey::MaxValue] = this->maxValue;
-      websiteObj[JsonKey::MinValue] = this->minValue;
-      websiteObj[JsonKey::IsVertical] = this->isVertical;
-      websiteObj[JsonKey::Color] = this->color;
-      websiteObj[JsonKey::ComponentType] = ComponentType::Output::ProgressBar;
+      addStaticFields(websiteObj);
+      addDynamicFields(websiteObj);
       return websiteObj;
     }
 
-    void setState(const JsonObjectConst& object) override{
+    JsonObject toStateJson() override {
+      JsonObject stateObj = jsonMemory->get()->to<JsonObject>();
+      stateObj[JsonKey::Name] = this->name;
+      addDynamicFields(stateObj);
+      return stateObj;
+    }
+
+    bool setState(const JsonObjectConst& object) override{
+      bool changed = false;
       if(object.containsKey(JsonKey::Value)){
-        this->value = object[JsonKey::Value];
+        changed |= update(this->value, object[JsonKey::Value].as<float>());
       }
       if(object.containsKey(JsonKey::Color)){
-        this->color.clear();
-        this->color = object[JsonKey::Color].as<const char*>();
+        changed |= this->color.set(object[JsonKey::Color].as<const char*>(), pool);
       }
+      return changed;
     }
   private:
-    String color;
+    SharedString color;
     uint16_t maxValue;
     uint16_t minValue;
     float value;
@@ -780,10 +1660,10 @@ namespace Website {
     bool isVertical;
   };
 
-  class ColorField : public OutputComponent{
+  class ColorField final : public OutputComponent {
   public:
-    explicit ColorField(const JsonObjectConst& inputObject)
-      : OutputComponent(inputObject){
+    ColorField(const JsonObjectConst& inputObject, StringPool& strings)
+      : OutputComponent(inputObject, strings){
       if(inputObject.containsKey(JsonKey::Width)){
         this->width = inputObject[JsonKey::Width];
       } else this->width = DefaultValues::Width;
@@ -791,39 +1671,57 @@ namespace Website {
         this->height = inputObject[JsonKey::Height];
       } else this->height = DefaultValues::Height;
       if(inputObject.containsKey(JsonKey::Color)){
-        this->color = inputObject[JsonKey::Color].as<const char*>();
+        this->color = strings.intern(inputObject[JsonKey::Color].as<const char*>());
       } else this->color = DefaultValues::Color;
       if(inputObject.containsKey(JsonKey::FieldOutlineColor)){
-        this->outlineColor = inputObject[JsonKey::FieldOutlineColor].as<const char*>();
+        this->outlineColor = strings.intern(inputObject[JsonKey::FieldOutlineColor].as<const char*>());
       } else this->outlineColor = DefaultValues::FieldOutlineColor;
     }
 
+    void addStaticFields(JsonObject& object) const {
+      object[JsonKey::Name] = this->name;
+      object[JsonKey::PosX] = this->posX;
+      object[JsonKey::PosY] = this->posY;
+      object[JsonKey::Width] = this->width;
+      object[JsonKey::Height] = this->height;
+      object[JsonKey::FieldOutlineColor] = this->outlineColor;
+      object[JsonKey::ComponentType] = ComponentType::Output::Field;
+    }
+
+    void addDynamicFields(JsonObject& object) const override {
+      object[JsonKey::Color] = this->color.c_str();
+    }
+
     JsonObject toWebsiteJson() override {
       JsonObject websiteObj = jsonMemory->get()->to<JsonObject>();
-      websiteObj[JsonKey::Name] = this->name;
-      websiteObj[JsonKey::PosX] = this->posX;
-      websiteObj[JsonKey::PosY] = this->posY;
-      websiteObj[JsonKey::Width] = this->width;
-      websiteObj[JsonKey::Height] = this->height;
-      websiteObj[JsonKey::Color] = this->color;
-      websiteObj[JsonKey::FieldOutlineColor] = this->outlineColor;
-      websiteObj[JsonKey::ComponentType] = ComponentType::Output::Field;
+      addStaticFields(websiteObj);
+      addDynamicFields(websiteObj);
       return websiteObj;
     }
-    void setState(const JsonObjectConst& object) override {
+
+    JsonObject toStateJson() override {
+      JsonObject stateObj = jsonMemory->get()->to<JsonObject>();
+      stateObj[JsonKey::Name] = this->name;
+      addDynamicFields(stateObj);
+      return stateObj;
+    }
+    bool setState(const JsonObjectConst& object) override {
       if(object.containsKey(JsonKey::Color)){
-        this->color = object[JsonKey::Color].as<String>();
+        return this->color.set(object[JsonKey::Color].as<const char*>(), pool);
       }
+      return false;
     }
   private:
     uint16_t width;
     uint16_t height;
-    String color;
-    String outlineColor;
+    SharedString color;
+    const char* outlineColor;
   };
 
 
 
+
+
   class Card {
   public:
     Card() = default;
@@ -835,102 +1733,361 @@ namespace Website {
     };
 
     ComponentStatus add(const JsonObjectConst& object);
-    JsonObject onHTTPRequest();
+    // state of one chunked /input response, lives as long as the response
+    struct ResponseCursor {
+      enum class Phase : uint8_t {HEADER, ELEMENTS, FOOTER};
+      uint32_t since = 0;                                       // 0 = whole layout, otherwise only components changed after this version
+      uint16_t next = 0;                                        // next component to serialize, layout order
+      String pending;                                           // part which did not fit into the previous TCP buffer
+      size_t pendingOffset = 0;
+      Phase phase = Phase::HEADER;
+      bool isFirst = true;
+    };
+    size_t fillHTTPResponse(ResponseCursor& cursor, uint8_t* buffer, size_t maxLen);
+    // calls fn for every output component changed after `since` in layout order, stops early when fn returns false
+    template <typename callback> void forEachChangedOutput(uint32_t since, callback fn);
     bool onComponentStatusHTTPRequest(const uint8_t *data, size_t len);
-    void reserve(size_t size);
+    // A /status body holding an array of messages. Each is parsed on its own, so the output memory stays sized for one message,
+    // and the applied ones reach Visuino as one batch. results gets an HTTP status per message, up to MaxStatusBatch;
+    // returns the number of messages, the ones past MaxStatusBatch are not applied.
+    size_t onComponentStatusBatch(const uint8_t* data, size_t len, uint16_t* results);
+    static const uint8_t MaxStatusBatch = 64;
+    bool onComponentStatusWebSocketMessage(const uint8_t *data, size_t len);
+    // The next input whose latest value waits for Visuino: one parked by a full EventQueue, then one queued by /ws.
+    // since gets the micros() it has been waiting from. Called from loop(), false when none waits.
+    bool takeStateInput(Visuino::Event& event, uint32_t& since);
+    // sizes the arena, the string pool and the component lists for a layout before its components are added
+    void reserve(const JsonArrayConst& elements);
+    // same for a loader which knows how many components of each type come (registry order) and the arena they took before
+    void reserve(const uint16_t* typeCounts, size_t arenaSize);
+    // takes over the layout text for the card's lifetime, returns it to be parsed in place - components then point into it
+    char* adoptLayout(String&& text);
+    // room in the arena for `length` bytes of strings which components then reference like an adopted layout, nullptr when out of memory
+    char* adoptStrings(size_t length);
+    static size_t getTypeCount() {return typeRegistrySize;}
+    static int16_t getTypeIndex(const char* componentType);   // position in the registry, -1 for an unknown type
+    bool isEmpty() const {return this->components.empty();}
     void garbageCollect();
+    const Arena& getArena() const {return this->arena;}
+    const StringPool& getStrings() const {return this->strings;}
+    // exact capacities of the documents built from the loaded components, grow as components are added
+    size_t getLargestObjectSize() const {return this->largestObjectSize;}   // toWebsiteJson(), the biggest toStateJson() fits too
+    size_t getLargestStatusSize() const;                                    // a /status or /ws message parsed into the output memory
+    uint32_t getVersion() const {return this->version;}
     const String& getTitle() const {return this->title;}
     void setTitle(const String& nTitle) {this->title = nTitle;}
 
     static void setJsonMemory(CommonJsonMemory* mem);
     static void setJsonMemoryForVisuino(CommonJsonMemory* mem);
-    static void lockJsonMemory();
-    static void releaseJsonMemory();
-    static bool isMemoryReadyToUse();
-
-    static void lockOutputJsonMemory();
-    static void releaseOutputJsonMemory();
-    static bool isOutputMemoryReadyToUse();
+    static CommonJsonMemory* getJsonMemory() {return jsonMemory;}
+    static CommonJsonMemory* getOutputJsonMemory() {return outputJsonMemory;}
 
   private:
+    typedef bool (Card::*ComponentHandler)(const JsonObjectConst& object);
+    struct TypeEntry {
+      const char* type;
+      ComponentHandler toWebsite;                               // creates the component, or updates an existing output component
+      ComponentHandler toVisuino;                               // state update coming from /status, nullptr for output components
+      bool coalesce;                                            // /ws may forward only the latest value per loop() tick
+      uint16_t objectSize;                                      // bytes the component object takes in the arena
+    };
+    static const TypeEntry typeRegistry[];
+    static const size_t typeRegistrySize;
+    static const TypeEntry* findType(const char* componentType);
+
+    template <typename componentType> bool createComponent(const JsonObjectConst& object);
+    template <typename componentType> bool cacheStaticJson(componentType& component);
+    static size_t statusMessageSize(const char* name, const char* componentType);
+    static void appendResponse(ResponseCursor& cursor, uint8_t* buffer, size_t maxLen, size_t& written, const char* data, size_t length);
+    static const size_t StaticFieldsSize = JSON_OBJECT_SIZE(12);
+    static const size_t DynamicFieldsSize = JSON_OBJECT_SIZE(4);
     template <typename componentType> bool parseInputComponentToWebsite(const JsonObjectConst& object);
     template <typename componentType> bool parseOutputComponentToWebsite(const JsonObjectConst& object);
-    template <typename componentType> bool parseInputComponentToVisuino(const JsonObjectConst& object);
+    bool parseInputComponentToVisuino(const JsonObjectConst& object);
+    InputComponent* applyStatus(const JsonObjectConst& object);
+  public:
     WebsiteComponent* getComponentByName(const char* name);
+    WebsiteComponent* getComponentById(uint16_t id) {return id < components.size() ? components[id] : nullptr;}
+    // by the handle of its name in getStrings(), nullptr when no component has that name
+    WebsiteComponent* getComponentByHandle(uint16_t handle);
+  private:
     bool componentAlreadyExists(const char* componentName);
-    std::vector<WebsiteComponent*> components;
+    bool addComponent(WebsiteComponent* component);
+    void markChanged(WebsiteComponent* component) {component->setChangedVersion(++this->version);}
+
+    std::vector<WebsiteComponent*> components;                 // layout order, position = component id
+    Arena arena;                                                // owns the component objects and their immutable strings
+    StringPool strings {arena};                                 // names, and colors and texts shared between components
+    std::vector<uint16_t> nameOwners;                           // name handle in strings -> slot in components, EmptySlot for other strings
+    std::vector<InputComponent*> pendingInputs;                 // changed over /ws since the last loop(), every component at most once
+    std::vector<InputComponent*> forwardedInputs;               // swapped with pendingInputs while forwarding, keeps both allocations
+    size_t forwardedNext = 0;                                   // next in forwardedInputs, a round ends when all were taken
+    size_t inputCount = 0;                                      // input components loaded, pendingInputs has room for all of them
+    size_t parkedNext = SIZE_MAX;                               // next component checked for a parked value, past the end = no scan
+    std::atomic_flag pendingLock = ATOMIC_FLAG_INIT;            // pendingInputs is filled by the async TCP task and drained by loop()
+    // held for a push or a swap, nothing allocates under it; yield() lets a preempted holder on the same core finish
+    void lockPending() {while(pendingLock.test_and_set(std::memory_order_acquire)) yield();}
+    void reservePending(size_t inputs);
     String title;
-    static CommonJsonMemory* jsonMemory;                        // main JSON memory, used for preparing data to /input HTTP request, size is all components size * 2 (common with parsing json)
+    String layoutText;                                          // adopted layout, unescaped in place by the parser
+    uint32_t version = 0;                                       // bumped on every component change, components keep the version of their last change
+    size_t largestObjectSize = 0;
+    size_t largestStatusSize = 0;
+    static CommonJsonMemory* jsonMemory;                        // main JSON memory, the parsed layout, /input only takes its lock
     static CommonJsonMemory* outputJsonMemory;                  // json document for visuino output - required for multicore ESP32 - on 8266 points on the same as "jsonMemory"
 };
 
   CommonJsonMemory* Card::jsonMemory;
   CommonJsonMemory* Card::outputJsonMemory;
 
+  // Every componentType the card understands, registered once here. Must stay sorted by strcmp order, findType() does a binary search.
+  // Output components have no toVisuino handler. Buttons never coalesce, a press and its release in one tick are both events.
+  // Chart registers here once it gets a component class.
+  const Card::TypeEntry Card::typeRegistry[] = {
+    {ComponentType::Input::Button,        &Card::parseInputComponentToWebsite<Button>,        &Card::parseInputComponentToVisuino, false, sizeof(Button)},
+    {ComponentType::Output::Field,        &Card::parseOutputComponentToWebsite<ColorField>,   nullptr,                             false, sizeof(ColorField)},
+    {ComponentType::Output::Gauge,        &Card::parseOutputComponentToWebsite<Gauge>,        nullptr,                             false, sizeof(Gauge)},
+    {ComponentType::Output::Indicator,    &Card::parseOutputComponentToWebsite<LedIndicator>, nullptr,                             false, sizeof(LedIndicator)},
+    {ComponentType::Output::Label,        &Card::parseOutputComponentToWebsite<Label>,        nullptr,                             false, sizeof(Label)},
+    {ComponentType::Input::NumberInput,   &Card::parseInputComponentToWebsite<NumberInput>,   &Card::parseInputComponentToVisuino, true,  sizeof(NumberInput)},
+    {ComponentType::Output::ProgressBar,  &Card::parseOutputComponentToWebsite<ProgressBar>,  nullptr,                             false, sizeof(ProgressBar)},
+    {ComponentType::Input::Slider,        &Card::parseInputComponentToWebsite<Slider>,        &Card::parseInputComponentToVisuino, true,  sizeof(Slider)},
+    {ComponentType::Input::Switch,        &Card::parseInputComponentToWebsite<Switch>,        &Card::parseInputComponentToVisuino, true,  sizeof(Switch)},
+  };
+  const size_t Card::typeRegistrySize = sizeof(Card::typeRegistry) / sizeof(Card::typeRegistry[0]);
+
+  const Card::TypeEntry* Card::findType(const char* componentType) {
+    if(componentType == nullptr) return nullptr;
+    size_t low = 0;
+    size_t high = typeRegistrySize;
+    while(low < high) {
+      size_t mid = (low + high) / 2;
+      int cmp = strcmp(componentType, typeRegistry[mid].type);
+      if(cmp == 0) return &typeRegistry[mid];
+      if(cmp < 0) high = mid;
+      else low = mid + 1;
+    }
+    return nullptr;
+  }
+
+  int16_t Card::getTypeIndex(const char* componentType) {
+    const TypeEntry* type = findType(componentType);
+    return type != nullptr ? static_cast<int16_t>(type - typeRegistry) : -1;
+  }
+
   Card::ComponentStatus Card::add(const JsonObjectConst& object) {
     if(!object.containsKey(JsonKey::Name) || !object.containsKey(JsonKey::ComponentType)) return ComponentStatus::OBJECT_NOT_VALID;
-    const char* componentType = object[JsonKey::ComponentType];
-    if(strlen(componentType) < 1) return ComponentStatus::COMPONENT_TYPE_NOT_FOUND;
-    using namespace ComponentType;
-
-    if(!strncmp(componentType, Input::Switch, strlen(componentType))) {
-      parseInputComponentToWebsite<Switch>(object);
-    } else if(!strncmp(componentType, Input::NumberInput, strlen(componentType))) {
-      parseInputComponentToWebsite<NumberInput>(object);
-    } else if(!strncmp(componentType, Input::Slider, strlen(componentType))){
-      parseInputComponentToWebsite<Slider>(object);
-    } else if(!strncmp(componentType, Input::Button, strlen(componentType))){
-      parseInputComponentToWebsite<Button>(object);
-    }
-    else if(!strncmp(componentType, Output::Label, strlen(componentType))){
-      parseOutputComponentToWebsite<Label>(object);
-    } else if(!strncmp(componentType, Output::Gauge, strlen(componentType))){
-      parseOutputComponentToWebsite<Gauge>(object);
-    } else if(!strncmp(componentType, Output::Indicator, strlen(componentType))){
-      parseOutputComponentToWebsite<LedIndicator>(object);
-    } else if(!strncmp(componentType, Output::ProgressBar, strlen(componentType))){
-      parseOutputComponentToWebsite<ProgressBar>(object);
-    } else if(!strncmp(componentType, Output::Field, strlen(componentType))){
-      parseOutputComponentToWebsite<ColorField>(object);
+    const TypeEntry* type = findType(object[JsonKey::ComponentType].as<const char*>());
+    if(type == nullptr) return ComponentStatus::COMPONENT_TYPE_NOT_FOUND;
+    (this->*type->toWebsite)(object);
+    return ComponentStatus::OK;
+  }
+
+  // Writes the next part of an /input response into the TCP buffer, one component at a time.
+  // Only the component being serialized is held in memory, a component bigger than the buffer waits in cursor.pending.
+  size_t Card::fillHTTPResponse(ResponseCursor& cursor, uint8_t* buffer, size_t maxLen) {
+    size_t written = 0;
+    while(written < maxLen) {
+      if(cursor.pendingOffset < cursor.pending.length()) {
+        size_t count = std::min(maxLen - written, cursor.pending.length() - cursor.pendingOffset);
+        memcpy(buffer + written, cursor.pending.c_str() + cursor.pendingOffset, count);
+        cursor.pendingOffset += count;
+        written += count;
+        continue;
+      }
+      cursor.pending.clear();
+      cursor.pendingOffset = 0;
+
+      if(cursor.phase == ResponseCursor::Phase::HEADER) {
+        if(cursor.since > this->version) cursor.since = 0;    // client remembers a version from before reboot/reload
+        char header[40];
+        snprintf(header, sizeof(header), "{\"%s\":%lu,\"%s\":[", JsonKey::Version,
+                 static_cast<unsigned long>(this->version), JsonKey::Elements);
+        cursor.pending = header;
+        cursor.phase = ResponseCursor::Phase::ELEMENTS;
+        continue;
+      }
+      if(cursor.phase == ResponseCursor::Phase::FOOTER) break;
+
+      // layout order, it is the page's paint order for overlapping elements
+      while(cursor.next < components.size() && components[cursor.next]->getChangedVersion() <= cursor.since) cursor.next++;
+      if(cursor.next == components.size()) {
+        cursor.pending = "]}";
+        cursor.phase = ResponseCursor::Phase::FOOTER;
+        continue;
+      }
+      const WebsiteComponent* found = components[cursor.next++];
+      // the static part is copied from the cache, only the dynamic fields are serialized, on the stack
+      StaticJsonDocument<DynamicFieldsSize> dynamicDoc;
+      JsonObject dynamicFields = dynamicDoc.to<JsonObject>();
+      found->addDynamicFields(dynamicFields);
+      if(!cursor.isFirst) appendResponse(cursor, buffer, maxLen, written, ",", 1);
+      appendResponse(cursor, buffer, maxLen, written, found->getStaticJson(), found->getStaticJsonLength());
+      char dynamic[64];
+      size_t length = measureJson(dynamicDoc);
+      if(length < sizeof(dynamic)) {
+        serializeJson(dynamicDoc, dynamic, sizeof(dynamic));
+        // "{}" has nothing to add, otherwise the fields follow the static ones without their opening brace
+        if(length > 2) appendResponse(cursor, buffer, maxLen, written, ",", 1);
+        appendResponse(cursor, buffer, maxLen, written, dynamic + 1, length - 1);
+      } else {
+        String longFields;                                      // long Label text
+        serializeJson(dynamicDoc, longFields);
+        appendResponse(cursor, buffer, maxLen, written, ",", 1);
+        appendResponse(cursor, buffer, maxLen, written, longFields.c_str() + 1, longFields.length() - 1);
+      }
+      cursor.isFirst = false;
     }
+    return written;
+  }
 
-    else {
-      return ComponentStatus::OBJECT_NOT_VALID;
+  // Copies what fits into the TCP buffer, the rest waits in cursor.pending for the next call
+  void Card::appendResponse(ResponseCursor& cursor, uint8_t* buffer, size_t maxLen, size_t& written, const char* data, size_t length) {
+    size_t count = cursor.pending.isEmpty() ? std::min(length, maxLen - written) : 0;
+    memcpy(buffer + written, data, count);
+    written += count;
+    if(count < length) cursor.pending.concat(data + count, length - count);
+  }
+
+  template<typename callback>
+  void Card::forEachChangedOutput(uint32_t since, callback fn) {
+    for(auto component : this->components) {
+      if(component->getChangedVersion() <= since) continue;
+      OutputComponent* output = component->asOutput();
+      if(output != nullptr && !fn(output)) return;
     }
-    return ComponentStatus::OK;
   }
 
-  JsonObject Card::onHTTPRequest() {
-    //jsonMemory should be already locked before calling this func!!
-    JsonObject object = jsonMemory->get()->to<JsonObject>();
-    JsonArray elements = object[JsonKey::Body].createNestedArray(JsonKey::Elements);
-    if(WebsiteComponent::isMemoryReadyToUse()){
-      WebsiteComponent::lockJsonMemory();     // lock component memory
-      for(auto component : this->components) {
-        elements.add(component->toWebsiteJson());
+  // Reads a request body in place, for the Stream based parsing and scanning the layout loader uses
+  class BodyStream : public Stream {
+  public:
+    BodyStream(const uint8_t* data, size_t len) : data(data), len(len) {}
+    int available() override {return static_cast<int>(len - position);}
+    int read() override {return position < len ? data[position++] : -1;}
+    int peek() override {return position < len ? data[position] : -1;}
+    size_t write(uint8_t) override {return 0;}
+    size_t tell() const {return position;}
+    void seek(size_t to) {position = std::min(to, len);}
+    // Moves past the value at the read position and the ',' after it, skipping nested arrays, objects and strings.
+    // False when the array's ']' or the end of the data came instead.
+    bool skipValue() {
+      uint16_t depth = 0;
+      bool inString = false;
+      for(; position < len; position++) {
+        char c = static_cast<char>(data[position]);
+        if(inString) {
+          if(c == '\\') position++;
+          else if(c == '"') inString = false;
+        } else if(c == '"') {
+          inString = true;
+        } else if(c == '{' || c == '[') {
+          depth++;
+        } else if(c == '}' || c == ']') {
+          if(depth == 0) break;
+          depth--;
+        } else if(c == ',' && depth == 0) {
+          position++;
+          return true;
+        }
       }
-      WebsiteComponent::releaseJsonMemory(); // components are copied to main memory, so we can release it.
+      return false;
     }
-    return object;
-  }
+  private:
+    const uint8_t* data;
+    size_t len;
+    size_t position = 0;
+  };
 
   bool Card::onComponentStatusHTTPRequest(const uint8_t* data, size_t len){
     deserializeJson(*outputJsonMemory->get(), reinterpret_cast<const char*>(data), len);
     auto receivedJson = outputJsonMemory->get()->as<JsonObject>();
-    const char* componentType = receivedJson[JsonKey::ComponentType];
-    using namespace ComponentType;
-    if(!strncmp(componentType, Input::Switch, strlen(componentType))) {
-      return parseInputComponentToVisuino<Switch>(receivedJson);
-    }else if(!strncmp(componentType, Input::Slider, strlen(componentType))){
-      return parseInputComponentToVisuino<Slider>(receivedJson);
-    } else if(!strncmp(componentType, Input::NumberInput, strlen(componentType))){
-      return parseInputComponentToVisuino<NumberInput>(receivedJson);
-    } else if(!strncmp(componentType, Input::Button, strlen(componentType))){
-      return parseInputComponentToVisuino<Button>(receivedJson);
+    const TypeEntry* type = findType(receivedJson[JsonKey::ComponentType].as<const char*>());
+    if(type == nullptr || type->toVisuino == nullptr) return false;
+    return (this->*type->toVisuino)(receivedJson);
+  }
+
+
+  // Same messages as /status. Values of coalescing types are applied right away but reach Visuino from takeStateInput(),
+  // a slider drag sending many values while the serial link is busy is forwarded once with the latest value.
+  bool Card::onComponentStatusWebSocketMessage(const uint8_t* data, size_t len) {
+    deserializeJson(*outputJsonMemory->get(), reinterpret_cast<const char*>(data), len);
+    auto receivedJson = outputJsonMemory->get()->as<JsonObject>();
+    const TypeEntry* type = findType(receivedJson[JsonKey::ComponentType].as<const char*>());
+    if(type == nullptr || type->toVisuino == nullptr) return false;
+    if(!type->coalesce) return (this->*type->toVisuino)(receivedJson);
+    InputComponent* component = applyStatus(receivedJson);
+    if(component == nullptr) return false;
+    this->lockPending();
+    if(!component->isVisuinoPending()) {
+      component->setVisuinoPending(true);
+      pendingInputs.push_back(component);
     }
-    return false;
+    pendingLock.clear(std::memory_order_release);
+    return true;
+  }
+
+  size_t Card::onComponentStatusBatch(const uint8_t* data, size_t len, uint16_t* results) {
+    BodyStream body(data, len);
+    body.setTimeout(0);
+    if(!body.find('[')) return 0;
+    while(isspace(body.peek())) body.read();
+    if(body.peek() == ']') return 0;
+    Visuino::Event events[MaxStatusBatch];
+    Visuino::OverflowSlot* slots[MaxStatusBatch];
+    uint16_t applied = 0;
+    size_t count = 0;
+    bool more = true;
+    do {
+      size_t start = body.tell();
+      bool valid = !deserializeJson(*outputJsonMemory->get(), body);
+      // a message which does not parse gets its 400 and the batch goes on with the next one
+      if(valid) more = body.findUntil(",", "]");
+      else {
+        body.seek(start);
+        more = body.skipValue();
+      }
+      if(count >= MaxStatusBatch) {
+        count++;
+        continue;
+      }
+      JsonObjectConst message = outputJsonMemory->get()->as<JsonObjectConst>();
+      const TypeEntry* type = valid ? findType(message[JsonKey::ComponentType].as<const char*>()) : nullptr;
+      InputComponent* component = type != nullptr && type->toVisuino != nullptr ? applyStatus(message) : nullptr;
+      results[count++] = component != nullptr ? HTTP_STATUS_OK : HTTP_STATUS_BAD_REQUEST;
+      if(component == nullptr) continue;
+      events[applied] = component->toVisuinoEvent();
+      slots[applied++] = &component->getOverflowSlot();
+    } while(more);
+    Visuino::queue.pushBatch(events, slots, applied);
+    return count;
   }
 
+  bool Card::takeStateInput(Visuino::Event& event, uint32_t& since) {
+    if(parkedNext >= components.size() && Visuino::queue.takeOverflow()) parkedNext = 0;
+    while(parkedNext < components.size()) {
+      InputComponent* input = components[parkedNext++]->asInput();
+      if(input == nullptr) continue;
+      event = input->toVisuinoEvent();
+      since = input->getOverflowSlot().parkedUs.load(std::memory_order_relaxed);
+      if(Visuino::queue.takeParked(input->getOverflowSlot(), event.value)) return true;
+    }
+    // /ws inputs go in rounds, an input changed again while its round runs waits for the next one
+    if(forwardedNext == forwardedInputs.size()) {
+      forwardedInputs.clear();
+      forwardedNext = 0;
+      this->lockPending();
+      pendingInputs.swap(forwardedInputs);
+      pendingLock.clear(std::memory_order_release);
+      if(forwardedInputs.empty()) return false;
+    }
+    InputComponent* input = forwardedInputs[forwardedNext++];
+    this->lockPending();
+    input->setVisuinoPending(false);
+    since = input->getPendingSince();
+    pendingLock.clear(std::memory_order_release);
+    event = input->toVisuinoEvent();
+    return true;
+  }
 
   bool Card::componentAlreadyExists(const char* componentName) {
     bool res = false;
@@ -939,22 +2096,115 @@ namespace Website {
 
   }
 
-  void Card::reserve(size_t size){
-    components.reserve(size);
+  // The arena gets what the layout needs: every component object, a copy of every name, each distinct pooled string once
+  // and the static JSON cache, estimated by the size of the element itself
+  void Card::reserve(const JsonArrayConst& elements){
+    uint16_t counts[typeRegistrySize] = {};
+    size_t arenaSize = 0;
+    std::vector<const char*> pooled;                            // points into the parsed layout, gone after this call
+    for(JsonObjectConst element : elements) {
+      const TypeEntry* type = findType(element[JsonKey::ComponentType].as<const char*>());
+      if(type == nullptr) continue;
+      counts[type - typeRegistry]++;
+      arenaSize += ((type->objectSize + alignof(std::max_align_t) - 1) & ~(alignof(std::max_align_t) - 1)) + measureJson(element);
+      for(JsonPairConst field : element) {
+        if(!field.value().is<const char*>()) continue;
+        const char* value = field.value().as<const char*>();
+        if(strings.isBorrowed(value)) continue;
+        if(StringPool::isPooled(field.key().c_str())) pooled.push_back(value);
+        else if(!strcmp(field.key().c_str(), JsonKey::Name)) arenaSize += strlen(value) + 1;
+      }
+    }
+    auto less = [] (const char* a, const char* b) {return strcmp(a, b) < 0;};
+    auto equal = [] (const char* a, const char* b) {return strcmp(a, b) == 0;};
+    std::sort(pooled.begin(), pooled.end(), less);
+    pooled.erase(std::unique(pooled.begin(), pooled.end(), equal), pooled.end());
+    for(const char* str : pooled) arenaSize += strlen(str) + 1;
+    this->reserve(counts, arenaSize);
+  }
+
+  void Card::reserve(const uint16_t* typeCounts, size_t arenaSize) {
+    size_t count = 0;
+    for(size_t i = 0; i < typeRegistrySize; i++) count += typeCounts[i];
+    size_t inputs = 0;
+    for(size_t i = 0; i < typeRegistrySize; i++) {
+      if(typeRegistry[i].toVisuino != nullptr) inputs += typeCounts[i];
+    }
+    this->reservePending(inputs);
+    components.reserve(count);
+    nameOwners.reserve(count * 2);                              // pooled colors and texts take handles between the names
+    strings.reserve(count);
+    arena.reserve(arenaSize);
   }
 
 
+  // An input is pending at most once, so room for every input means push_back() under pendingLock never allocates.
+  // The swap in takeStateInput() hands the allocations back and forth, both vectors get the room.
+  void Card::reservePending(size_t inputs) {
+    if(inputs <= forwardedInputs.capacity() && inputs <= pendingInputs.capacity()) return;
+    inputs = std::max(inputs, forwardedInputs.capacity() * 2);
+    forwardedInputs.reserve(inputs);
+    std::vector<InputComponent*> room;                          // allocated outside the lock, moved in under it
+    room.reserve(inputs);
+    this->lockPending();
+    room.insert(room.end(), pendingInputs.begin(), pendingInputs.end());
+    pendingInputs.swap(room);
+    pendingLock.clear(std::memory_order_release);
+  }
+
   void Card::garbageCollect() {
-    for(auto component : this->components) delete component;
+    this->lockPending();
+    pendingInputs.clear();
+    pendingLock.clear(std::memory_order_release);
+    forwardedInputs.clear();
+    forwardedNext = 0;
+    inputCount = 0;
+    parkedNext = SIZE_MAX;
+    // the objects live in the arena, only their heap members need the destructors
+    for(auto component : this->components) component->~WebsiteComponent();
     components.clear();
+    nameOwners.clear();
+    strings.clear();
+    arena.release();
+    layoutText = String();
+    largestObjectSize = 0;
+    largestStatusSize = 0;
+  }
+
+  char* Card::adoptLayout(String&& text) {
+    layoutText = std::move(text);
+    strings.borrow(layoutText.c_str(), layoutText.length());
+    return layoutText.begin();
+  }
+
+  char* Card::adoptStrings(size_t length) {
+    auto place = static_cast<char*>(arena.allocate(length, 1));
+    if(place != nullptr) strings.borrow(place, length);
+    return place;
   }
 
 
   WebsiteComponent* Card::getComponentByName(const char *name) {
-    for(auto component : this->components){
-      if(component->getName().equals(name)) return component;
-    }
-    return nullptr;
+    int32_t handle = strings.find(name);
+    return handle >= 0 ? getComponentByHandle(static_cast<uint16_t>(handle)) : nullptr;
+  }
+
+  WebsiteComponent* Card::getComponentByHandle(uint16_t handle) {
+    if(handle >= nameOwners.size() || nameOwners[handle] == ComponentIndex::EmptySlot) return nullptr;
+    return components[nameOwners[handle]];
+  }
+
+  bool Card::addComponent(WebsiteComponent* component) {
+    if(components.size() >= ComponentIndex::MaxComponents) return false;
+    uint16_t handle = component->getNameHandle();
+    const uint16_t none = ComponentIndex::EmptySlot;
+    if(handle >= nameOwners.size()) nameOwners.resize(strings.size(), none);
+    if(component->asInput() != nullptr) this->reservePending(++inputCount);
+    component->setId(static_cast<uint16_t>(components.size()));
+    if(nameOwners[handle] == none) nameOwners[handle] = component->getId();    // a repeated name keeps finding the first component
+    components.push_back(component);
+    markChanged(component);
+    return true;
   }
 
   void Card::setJsonMemory(CommonJsonMemory* mem) {
@@ -962,81 +2212,93 @@ namespace Website {
   }
 
   template<typename componentType>
-  bool Card::parseOutputComponentToWebsite(const JsonObjectConst& object) {
-    const char* componentName = object[JsonKey::Name];
-    if(!componentAlreadyExists(componentName)){
-      auto component = new componentType(object);
-      if(component->isInitializedOK()) components.push_back(component);
-      else {
-        delete component;
-        return false;
-      }
-    } else {
-      auto component = reinterpret_cast<componentType*>(getComponentByName(componentName));
-      if(component != nullptr) component->setState(object);
-      else return false;
+  bool Card::createComponent(const JsonObjectConst& object) {
+    Arena::Marker mark = arena.mark();
+    size_t stringsMark = strings.mark();
+    auto component = arena.create<componentType>(object, strings);
+    if(component == nullptr) return false;
+    if(!component->isInitializedOK() || !cacheStaticJson(*component) || !addComponent(component)) {
+      component->~componentType();
+      strings.rollback(stringsMark);
+      arena.rollback(mark);
+      return false;
+    }
+    if(std::is_base_of<InputComponent, componentType>::value) {
+      size_t statusSize = statusMessageSize(component->getName(), object[JsonKey::ComponentType].as<const char*>());
+      if(statusSize > largestStatusSize) largestStatusSize = statusSize;
     }
     return true;
   }
 
+  // Messages from the website are {name, componentType, value}, the value is a bool or a number.
+  // They are parsed from a const buffer, so ArduinoJson copies every key and string.
+  size_t Card::statusMessageSize(const char* name, const char* componentType) {
+    return JSON_OBJECT_SIZE(3) + JSON_STRING_SIZE(strlen(JsonKey::Name)) + JSON_STRING_SIZE(strlen(JsonKey::ComponentType)) +
+           JSON_STRING_SIZE(strlen(JsonKey::Value)) + JSON_STRING_SIZE(strlen(name)) + JSON_STRING_SIZE(strlen(componentType));
+  }
+
+  size_t Card::getLargestStatusSize() const {
+    // a layout without inputs still parses messages to reject them
+    return this->largestStatusSize > 0 ? this->largestStatusSize : statusMessageSize("", "");
+  }
+
   template<typename componentType>
-  bool Card::parseInputComponentToWebsite(const JsonObjectConst& object) {
-    const char* componentName = object[JsonKey::Name];
-    if(!componentAlreadyExists(componentName)){
-      auto component = new componentType(object);
-      if(component->isInitializedOK()) components.push_back(component);
-      else {
-        delete component;
-        return false;
-      }
-    }
+  bool Card::cacheStaticJson(componentType& component) {
+    StaticJsonDocument<StaticFieldsSize> doc;
+    JsonObject object = doc.to<JsonObject>();
+    component.addStaticFields(object);
+    if(doc.overflowed()) return false;
+    size_t length = measureJson(object);
+    auto json = static_cast<char*>(arena.allocate(length + 1, 1));
+    if(json == nullptr) return false;
+    serializeJson(object, json, length + 1);
+    component.setStaticJson(json, static_cast<uint16_t>(length - 1));
+    // strings are linked, not copied, so the whole object costs the same in the component memory
+    component.addDynamicFields(object);
+    if(doc.memoryUsage() > largestObjectSize) largestObjectSize = doc.memoryUsage();
     return true;
   }
 
   template<typename componentType>
-  bool Card::parseInputComponentToVisuino(const JsonObjectConst& object) {
+  bool Card::parseOutputComponentToWebsite(const JsonObjectConst& object) {
     const char* componentName = object[JsonKey::Name];
-    auto component = reinterpret_cast<InputComponent*>(getComponentByName(componentName));
-    if(component == nullptr) return false;
-    component->setState(object);
-    if(WebsiteComponent::isMemoryReadyToUse()){
-      WebsiteComponent::lockJsonMemory();
-      componentType::setVisuinoOutput(component->toVisuinoJson());
-      WebsiteComponent::releaseJsonMemory();
-    } else return false;
+    auto existing = getComponentByName(componentName);
+    if(existing == nullptr){
+      return createComponent<componentType>(object);
+    } else if(existing->setState(object)) {
+      markChanged(existing);
+    }
     return true;
   }
 
-  void Card::lockJsonMemory() {
-    if(jsonMemory != nullptr) jsonMemory->lock();
+  template<typename componentType>
+  bool Card::parseInputComponentToWebsite(const JsonObjectConst& object) {
+    const char* componentName = object[JsonKey::Name];
+    if(!componentAlreadyExists(componentName)){
+      return createComponent<componentType>(object);
+    }
+    return true;
   }
 
-  void Card::releaseJsonMemory() {
-    if(jsonMemory != nullptr) jsonMemory->unlock();
+  // Sets the state of the input component a /status or /ws message names, nullptr when there is no such input
+  InputComponent* Card::applyStatus(const JsonObjectConst& object) {
+    WebsiteComponent* found = getComponentByName(object[JsonKey::Name].as<const char*>());
+    InputComponent* component = found != nullptr ? found->asInput() : nullptr;
+    if(component != nullptr && component->setState(object)) markChanged(component);
+    return component;
   }
 
-  bool Card::isMemoryReadyToUse() {
-    if(jsonMemory != nullptr) return jsonMemory->isReadyToUse();
-    else return false;
+  bool Card::parseInputComponentToVisuino(const JsonObjectConst& object) {
+    InputComponent* component = applyStatus(object);
+    if(component == nullptr) return false;
+    Visuino::queue.push(component->toVisuinoEvent(), &component->getOverflowSlot());
+    return true;
   }
 
   void Card::setJsonMemoryForVisuino(CommonJsonMemory *mem) {
     outputJsonMemory = mem;
   }
 
-  void Card::lockOutputJsonMemory() {
-    if(outputJsonMemory != nullptr) outputJsonMemory->lock();
-  }
-
-  void Card::releaseOutputJsonMemory() {
-    if(outputJsonMemory != nullptr) outputJsonMemory->unlock();
-  }
-
-  bool Card::isOutputMemoryReadyToUse() {
-    if(outputJsonMemory != nullptr) return outputJsonMemory->isReadyToUse();
-    return false;
-  }
-
 
 }
 
@@ -1325,7 +2587,6 @@ String testWebsiteConfigStr = {R"(
 Website::Card card;
 
 namespace JsonReader {
-  size_t memorySize = 0;
   CommonJsonMemory inputJsonMemory;
   CommonJsonMemory componentJsonMemory;
 #ifdef ESP32
@@ -1349,100 +2610,248 @@ namespace JsonReader {
     return !(json.isEmpty() || json.indexOf(JsonKey::Name) < 0);
   }
 
-  size_t getBiggestObjectSize(const JsonArrayConst& arr){
-    size_t biggest = 0;
-    for (const auto& item : arr) {
-      if(item.memoryUsage() > biggest) biggest = item.memoryUsage();
+  uint8_t hexValue(char c) {
+    if(c >= '0' && c <= '9') return c - '0';
+    return (c | 0x20) - 'a' + 10;
+  }
+
+  // Bytes a JSON string takes once unescaped, i is just past the opening quote and ends just past the closing one
+  size_t scanString(const char* json, size_t length, size_t& i) {
+    size_t bytes = 0;
+    while(i < length && json[i] != '"') {
+      if(json[i] == '\\' && i + 5 < length && json[i + 1] == 'u') {
+        uint16_t code = 0;
+        for(size_t k = i + 2; k < i + 6; k++) code = code * 16 + hexValue(json[k]);
+        if(code < 0x80) bytes += 1;
+        else if(code < 0x800) bytes += 2;
+        else if(code >= 0xD800 && code < 0xDC00) bytes += 4;      // high surrogate, the pair becomes one 4 byte character
+        else if(code < 0xD800 || code >= 0xE000) bytes += 3;
+        i += 6;
+        continue;
+      }
+      i += json[i] == '\\' ? 2 : 1;
+      bytes++;
     }
-    return biggest;
+    i++;
+    return bytes;
   }
-  
-  size_t getBufferSize(size_t memoryUsage){
-    size_t newSize = memoryUsage * 2;
-    return newSize;
+
+  // Capacity ArduinoJson needs to parse json, counted from the text instead of guessed from its length:
+  // a slot for every object member and array element, and unless parsed in place, every key and string value copied with its terminator.
+  // With deduplication equal strings are stored once, but a string is copied before it is found to be a duplicate,
+  // so the longest one gets room on top.
+  size_t measureCapacity(const char* json, size_t length, bool copiesStrings = true) {
+    size_t values = 0;
+    size_t stringBytes = 0;
+#if ARDUINOJSON_ENABLE_STRING_DEDUPLICATION
+    struct Text {
+      const char* begin;
+      size_t length;
+      size_t bytes;
+    };
+    std::vector<Text> texts;
+#endif
+    for(size_t i = 0; i < length;) {
+      char c = json[i];
+      if(c == '"') {
+        size_t begin = ++i;
+        size_t bytes = scanString(json, length, i);
+        size_t next = i;
+        while(next < length && isspace(static_cast<unsigned char>(json[next]))) next++;
+        if(next >= length || json[next] != ':') values++;         // otherwise a key, stored in its member's slot
+        if(!copiesStrings) continue;
+#if ARDUINOJSON_ENABLE_STRING_DEDUPLICATION
+        texts.push_back(Text {json + begin, i - 1 - begin, bytes});
+#else
+        (void)begin;
+        stringBytes += JSON_STRING_SIZE(bytes);
+#endif
+      } else if(c == '{' || c == '[') {
+        values++;
+        i++;
+      } else if(c == '-' || isdigit(static_cast<unsigned char>(c)) || c == 't' || c == 'f' || c == 'n') {
+        values++;
+        while(i < length && !strchr(",]} \t\r\n", json[i])) i++;
+      } else i++;
+    }
+#if ARDUINOJSON_ENABLE_STRING_DEDUPLICATION
+    std::sort(texts.begin(), texts.end(), [] (const Text& a, const Text& b) {
+      return a.length != b.length ? a.length < b.length : memcmp(a.begin, b.begin, a.length) < 0;
+    });
+    size_t longest = 0;
+    for(size_t i = 0; i < texts.size(); i++) {
+      if(texts[i].bytes > longest) longest = texts[i].bytes;
+      if(i > 0 && texts[i].length == texts[i - 1].length && !memcmp(texts[i].begin, texts[i - 1].begin, texts[i].length)) continue;
+      stringBytes += JSON_STRING_SIZE(texts[i].bytes);
+    }
+    if(!texts.empty()) stringBytes += JSON_STRING_SIZE(longest);
+#endif
+    // the root lives in the document itself, members and elements take one slot each
+    return (values > 0 ? values - 1 : 0) * JSON_ARRAY_SIZE(1) + stringBytes;
+  }
+
+  // Allocates on first use, later only when a layout update needs more, the old document is dropped under its lock
+  bool fitMemory(CommonJsonMemory& memory, size_t size) {
+    DynamicJsonDocument* doc = memory.get();
+    if(doc != nullptr && doc->capacity() >= size) return true;
+    CommonJsonMemory::Guard guard(doc != nullptr ? &memory : nullptr, JSON_MEMORY_WAIT_MS);
+    if(doc != nullptr && !guard) return false;
+    memory.garbageCollect();
+    if(memory.allocate(size)) return true;
+    memory.garbageCollect();
+    return false;
   }
 
   // ESP32 needs second JSON document because of multicore architecture and it could not be common with input memory
   bool setVisuinoOutputMemory(size_t size){
 #ifdef ESP32
-    if(visuinoOutputJsonMemory.allocate(size)){
-      Website::Card::setJsonMemoryForVisuino(&visuinoOutputJsonMemory);
-      return true;
-    } else{
-      visuinoOutputJsonMemory.garbageCollect();
-      return false;
-    }
+    if(!fitMemory(visuinoOutputJsonMemory, size)) return false;
+    Website::Card::setJsonMemoryForVisuino(&visuinoOutputJsonMemory);
+    return true;
 #endif
 #ifdef ESP8266
     Website::Card::setJsonMemoryForVisuino(&inputJsonMemory);
-    return true;
+    return fitMemory(inputJsonMemory, size);
 #endif
   }
 
-  InputJsonStatus readWebsiteComponentsFromJson(const String& json) {
+  // Sizes the documents which serialize components and parse /status for what the card holds now
+  InputJsonStatus fitOutputMemory() {
     using namespace Website;
-    static bool isValid = false;
-    static bool isInitialized = false;
-    static bool isElementsInitialized = false;
-    isValid = validateJson(json);
-    if (isValid) {
-      if (!isInitialized) {
-        memorySize = json.length();
-        Serial.println((int)memorySize);
-        if (inputJsonMemory.allocate(getBufferSize(memorySize))) {
-          Website::Card::setJsonMemory(&inputJsonMemory);
-          isInitialized = true;
-        } else {
-          inputJsonMemory.garbageCollect();
-          return InputJsonStatus::ALLOC_ERROR;
-        }
-      }
-
-      if(inputJsonMemory.isReadyToUse()){
+    if(!setVisuinoOutputMemory(card.getLargestStatusSize())) return InputJsonStatus::ALLOC_ERROR;
+    if(!fitMemory(componentJsonMemory, card.getLargestObjectSize())) return InputJsonStatus::ALLOC_ERROR;
+    WebsiteComponent::setJsonMemory(&componentJsonMemory);
+    return InputJsonStatus::OK;
+  }
 
-        // unlock json memory before returning
-        auto releaseAndReturn = [&] (InputJsonStatus status) {
-          inputJsonMemory.unlock();
-          return status;
-        };
+  // Parses json into the input memory and adds its elements. A const String is copied into the document,
+  // a char* is parsed in place and the document points into it.
+  template <typename source>
+  InputJsonStatus readElements(source json, size_t capacity) {
+    using namespace Website;
+    if (!fitMemory(inputJsonMemory, capacity)) return InputJsonStatus::ALLOC_ERROR;
+    Website::Card::setJsonMemory(&inputJsonMemory);
 
-        inputJsonMemory.lock();
+    InputJsonStatus status = InputJsonStatus::OK;
+    {
+      CommonJsonMemory::Guard guard(&inputJsonMemory, JSON_MEMORY_WAIT_MS);
+      if(guard){
         deserializeJson(*inputJsonMemory.get(), json);
-        if (inputJsonMemory.get()->overflowed()) return releaseAndReturn(InputJsonStatus::JSON_OVERFLOW);
+        if (inputJsonMemory.get()->overflowed()) return InputJsonStatus::JSON_OVERFLOW;
 
         JsonObject inputObject = inputJsonMemory.get()->as<JsonObject>();
-        if (!inputObject.containsKey(JsonKey::Elements)) return releaseAndReturn(InputJsonStatus::ELEMENTS_NOT_FOUND);
+        if (!inputObject.containsKey(JsonKey::Elements)) return InputJsonStatus::ELEMENTS_NOT_FOUND;
         JsonArray elements = inputObject[JsonKey::Elements].as<JsonArray>();
-        if (elements.size() == 0) return releaseAndReturn(InputJsonStatus::ELEMENTS_ARRAY_EMPTY);
-        if(!isElementsInitialized) {
-          size_t biggestObjectSize = getBiggestObjectSize(elements);
-
-          if(!setVisuinoOutputMemory(getBufferSize(biggestObjectSize))) return releaseAndReturn(InputJsonStatus::ALLOC_ERROR);
-          if(componentJsonMemory.allocate(getBufferSize(biggestObjectSize))){
-            WebsiteComponent::setJsonMemory(&componentJsonMemory);
-            isElementsInitialized = true;
-          } else {
-            componentJsonMemory.garbageCollect();
-            return releaseAndReturn(InputJsonStatus::ALLOC_ERROR);
-          }
-        }
+        if (elements.size() == 0) return InputJsonStatus::ELEMENTS_ARRAY_EMPTY;
 
-        card.reserve(elements.size());
+        card.reserve(elements);
         for (JsonObject element : elements) {
           auto res = card.add(element);
           if(res == Card::ComponentStatus::COMPONENT_TYPE_NOT_FOUND){
-            return releaseAndReturn(InputJsonStatus::COMPONENT_TYPE_NOT_FOUND);
+            status = InputJsonStatus::COMPONENT_TYPE_NOT_FOUND;
+            break;
           }
           else if (res != Card::ComponentStatus::OK) {
-            return releaseAndReturn(InputJsonStatus::OBJECT_NOT_VALID);
+            status = InputJsonStatus::OBJECT_NOT_VALID;
+            break;
           }
         }
-        inputJsonMemory.unlock();
       }
+    }
+    // the components added so far are served even when a later element failed
+    if (card.getLargestObjectSize() > 0) {
+      InputJsonStatus fitted = fitOutputMemory();
+      if (fitted != InputJsonStatus::OK) return fitted;
+    }
+    return status;
+  }
+
+  // Layout updates, the text can be dropped afterwards - new components copy their strings into the card's arena
+  InputJsonStatus readWebsiteComponentsFromJson(const String& json) {
+    if (!validateJson(json)) return InputJsonStatus::OK;
+    // sized for the first layout, an update needing more grows it
+    return readElements<const String&>(json, measureCapacity(json.c_str(), json.length()));
+  }
+
+  // First layout of an empty card: the card keeps the text and parses it in place, so every string of the layout
+  // exists once in RAM and components reference it. A card which already has components takes json as an update.
+  InputJsonStatus loadLayout(String&& json) {
+    if (!card.isEmpty()) return readWebsiteComponentsFromJson(json);
+    if (!validateJson(json)) return InputJsonStatus::OK;
+    size_t capacity = measureCapacity(json.c_str(), json.length(), false);
+    return readElements<char*>(card.adoptLayout(std::move(json)), capacity);
+  }
+
+  // Moves the stream past the ':' of `key` in the outermost object. Keys of nested objects and strings are stepped over,
+  // so a value holding the key's text is not taken for it.
+  bool findTopLevelKey(Stream& stream, const char* key) {
+    int depth = 0;
+    char c;
+    while (stream.readBytes(&c, 1) == 1) {
+      if (c == '{' || c == '[') depth++;
+      else if (c == '}' || c == ']') {
+        if (--depth <= 0) return false;
+      } else if (c == '"') {
+        const char* expected = depth == 1 ? key : nullptr;
+        bool escaped = false;
+        while (stream.readBytes(&c, 1) == 1 && (escaped || c != '"')) {
+          if (expected != nullptr) expected = !escaped && c != '\\' && *expected == c ? expected + 1 : nullptr;
+          escaped = !escaped && c == '\\';
+        }
+        if (expected == nullptr || *expected != '\0') continue;
+        while (isspace(stream.peek())) stream.read();
+        if (stream.peek() == ':') {
+          stream.read();
+          return true;
+        }
+      }
+    }
+    return false;
+  }
 
+  // Reads the layout from a Stream, a SPIFFS file or an upload body, one element at a time. Each element is parsed into the
+  // input memory and built into its component before the next one is read, so neither the text nor a document of the whole
+  // layout is ever in RAM. Nothing is reserved up front, the card grows as components arrive.
+  InputJsonStatus readWebsiteComponentsFromStream(Stream& stream, size_t elementCapacity = JSON_ELEMENT_CAPACITY) {
+    using namespace Website;
+    if (!fitMemory(inputJsonMemory, elementCapacity)) return InputJsonStatus::ALLOC_ERROR;
+    Website::Card::setJsonMemory(&inputJsonMemory);
 
+    InputJsonStatus status = InputJsonStatus::OK;
+    {
+      CommonJsonMemory::Guard guard(&inputJsonMemory, JSON_MEMORY_WAIT_MS);
+      if(guard){
+        if (!findTopLevelKey(stream, JsonKey::Elements)) return InputJsonStatus::ELEMENTS_NOT_FOUND;
+        while (isspace(stream.peek())) stream.read();
+        if (stream.read() != '[') return InputJsonStatus::ELEMENTS_NOT_FOUND;
+        while (isspace(stream.peek())) stream.read();
+        if (stream.peek() == ']') return InputJsonStatus::ELEMENTS_ARRAY_EMPTY;
+        do {
+          DeserializationError error = deserializeJson(*inputJsonMemory.get(), stream);
+          if (error == DeserializationError::NoMemory) status = InputJsonStatus::JSON_OVERFLOW;
+          else if (error) status = InputJsonStatus::INVALID_INPUT;
+          else {
+            auto res = card.add(inputJsonMemory.get()->as<JsonObjectConst>());
+            if(res == Card::ComponentStatus::COMPONENT_TYPE_NOT_FOUND) status = InputJsonStatus::COMPONENT_TYPE_NOT_FOUND;
+            else if (res != Card::ComponentStatus::OK) status = InputJsonStatus::OBJECT_NOT_VALID;
+          }
+        } while (status == InputJsonStatus::OK && stream.findUntil(",", "]"));
+      }
     }
-    return InputJsonStatus::OK;
+    if (card.getLargestObjectSize() > 0) {
+      InputJsonStatus fitted = fitOutputMemory();
+      if (fitted != InputJsonStatus::OK) return fitted;
+    }
+    return status;
+  }
+
+  void memoryBudget() {
+    auto capacity = [] (CommonJsonMemory& memory) -> uint32_t {return memory.get() != nullptr ? memory.get()->capacity() : 0;};
+    Log::info(Log::LayoutBudgetMsg, capacity(inputJsonMemory));
+    Log::info(Log::ComponentBudgetMsg, capacity(componentJsonMemory));
+#ifdef ESP32
+    Log::info(Log::VisuinoBudgetMsg, capacity(visuinoOutputJsonMemory));
+#endif
   }
 
 
@@ -1485,80 +2894,995 @@ namespace JsonReader {
   }
 }
 
+// Little endian files written and read in one pass, shared by the layout snapshot and the asset bundle
+namespace Binary {
+  uint32_t hash(const uint8_t* data, size_t length, uint32_t h = 2166136261u) {
+    for(size_t i = 0; i < length; i++) {
+      h ^= data[i];                                             // FNV-1a
+      h *= 16777619u;
+    }
+    return h;
+  }
+
+  // reads the file to its end
+  uint32_t hash(File& file, uint32_t h = 2166136261u) {
+    uint8_t buffer[64];
+    size_t count;
+    while((count = file.readBytes(reinterpret_cast<char*>(buffer), sizeof(buffer))) > 0) h = hash(buffer, count, h);
+    return h;
+  }
+
+  // Counts and hashes what is written and passes it on to out, without out it only measures
+  class Writer : public Print {
+  public:
+    explicit Writer(Print* out) : out(out) {}
+    size_t write(uint8_t c) override {return this->write(&c, 1);}
+    size_t write(const uint8_t* buffer, size_t size) override {
+      size_t written = out != nullptr ? out->write(buffer, size) : size;
+      checksum = hash(buffer, written, checksum);
+      count += written;
+      return written;
+    }
+    using Print::write;
+    template <typename type> void put(type value) {
+      uint8_t bytes[sizeof(type)];
+      for(size_t i = 0; i < sizeof(type); i++) bytes[i] = static_cast<uint8_t>(value >> (8 * i));
+      this->write(bytes, sizeof(type));
+    }
+    uint32_t checksum = 2166136261u;
+    size_t count = 0;
+  private:
+    Print* out;
+  };
+
+  // Sequential reads bounded by what the stream had when the reader was made, a short or damaged file fails instead of overrunning
+  class Reader {
+  public:
+    explicit Reader(Stream& in) : in(in), remaining(in.available() > 0 ? in.available() : 0) {}
+    bool read(void* data, size_t length) {
+      if(failed || length > remaining || in.readBytes(static_cast<char*>(data), length) != length) failed = true;
+      else {
+        checksum = hash(static_cast<const uint8_t*>(data), length, checksum);
+        remaining -= length;
+      }
+      return !failed;
+    }
+    template <typename type> type get() {
+      uint8_t bytes[sizeof(type)] = {};
+      this->read(bytes, sizeof(type));
+      type value = 0;
+      for(size_t i = 0; i < sizeof(type); i++) value |= static_cast<type>(bytes[i]) << (8 * i);
+      return value;
+    }
+    explicit operator bool() const {return !failed;}
+    size_t left() const {return remaining;}
+    uint32_t checksum = 2166136261u;                            // of everything read so far
+  private:
+    Stream& in;
+    size_t remaining;
+    bool failed = false;
+  };
+}
+
+// Binary snapshot of the card, written once a layout has been parsed and loaded at the next boot instead of parsing it again.
+// File, multi-byte fields little endian:
+//   header:  magic "VUIS" (4) | format version (2) | registry size (2) | layout hash (4) | components (2) | arena bytes (4)
+//            | string bytes (4) | record bytes (4) | components per type, registry order (2 each)
+//   strings: every distinct string value of the card once, NUL terminated, referenced by offset
+//   records: per component in layout order: field count (1), then per field: key (1, index into Keys) | tag (1) | value (0 or 4)
+//   trailer: FNV-1a of everything before it (4)
+// A record holds what toWebsiteJson() gives, current values included, and goes through Card::add() like a layout element.
+// The layout hash is seeded with the build time, so a reflashed firmware parses the layout once more.
+namespace Snapshot {
+  const uint32_t Magic = 0x53495556;                            // "VUIS"
+  const uint16_t FormatVersion = 1;
+  const uint8_t MaxFields = 16;
+  const size_t RecordCapacity = JSON_OBJECT_SIZE(MaxFields);    // keys and strings are linked, nothing is copied into the document
+
+  // record keys by index, changing the order needs a new FormatVersion
+  const char* const Keys[] PROGMEM = {
+    JsonKey::Name, JsonKey::Width, JsonKey::Height, JsonKey::PosX, JsonKey::PosY, JsonKey::ComponentType, JsonKey::Value,
+    JsonKey::Color, JsonKey::FontSize, JsonKey::Text, JsonKey::TextColor, JsonKey::IsVertical, JsonKey::Size,
+    JsonKey::FieldOutlineColor, JsonKey::MaxValue, JsonKey::MinValue,
+  };
+  const uint8_t KeyCount = sizeof(Keys) / sizeof(Keys[0]);
+
+  enum class Tag : uint8_t {NONE, BOOL_FALSE, BOOL_TRUE, SIGNED, UNSIGNED, REAL, STRING};
+
+  enum class Status : uint8_t {
+    OK,
+    MISSING,
+    STALE,                                                      // another layout, firmware or format, parsing it is expected
+    CORRUPT,
+    ALLOC_ERROR,
+  };
+
+  using Binary::hash;
+  using Binary::Reader;
+  using Binary::Writer;
+
+  void put(Writer& out, Tag tag) {out.put(static_cast<uint8_t>(tag));}
+
+  uint32_t buildSeed() {
+    const char* build = __DATE__ " " __TIME__;
+    return hash(reinterpret_cast<const uint8_t*>(build), strlen(build));
+  }
+
+  uint32_t layoutHash(const String& text) {
+    return hash(reinterpret_cast<const uint8_t*>(text.c_str()), text.length(), buildSeed());
+  }
+
+  // the caller seeks back before parsing the file
+  uint32_t layoutHash(File& file) {
+    return hash(file, buildSeed());
+  }
+
+  // Distinct strings of the card, in the order they were first seen
+  class StringTable {
+  public:
+    // offset of str, appended when new, -1 when the table is full
+    int32_t offsetOf(const char* str) {
+      int32_t slot = index.find(str, [this] (uint16_t i) {return this->text.data() + this->offsets[i];});
+      if(slot >= 0) return offsets[slot];
+      if(offsets.size() >= Website::ComponentIndex::MaxComponents || (index.needsGrow() && !this->grow())) return -1;
+      uint32_t offset = text.size();
+      text.insert(text.end(), str, str + strlen(str) + 1);
+      index.insert(str, static_cast<uint16_t>(offsets.size()));
+      offsets.push_back(offset);
+      return offset;
+    }
+    const uint8_t* data() const {return reinterpret_cast<const uint8_t*>(text.data());}
+    size_t size() const {return text.size();}
+  private:
+    bool grow() {
+      if(!index.reserve(std::min<size_t>(offsets.size() * 2 + 8, Website::ComponentIndex::MaxComponents))) return false;
+      for(size_t i = 0; i < offsets.size(); i++) index.insert(text.data() + offsets[i], static_cast<uint16_t>(i));
+      return true;
+    }
+    std::vector<char> text;
+    std::vector<uint32_t> offsets;
+    Website::ComponentIndex index;
+  };
+
+  uint8_t keyIndex(const char* key) {
+    for(uint8_t i = 0; i < KeyCount; i++) {
+      if(!strcmp(Keys[i], key)) return i;
+    }
+    return KeyCount;
+  }
+
+  bool writeRecord(Writer& out, JsonObjectConst object, StringTable& strings) {
+    if(object.size() > MaxFields) return false;
+    out.put(static_cast<uint8_t>(object.size()));
+    for(JsonPairConst field : object) {
+      uint8_t key = keyIndex(field.key().c_str());
+      if(key == KeyCount) return false;
+      out.put(key);
+      JsonVariantConst value = field.value();
+      if(value.is<bool>()) put(out, value.as<bool>() ? Tag::BOOL_TRUE : Tag::BOOL_FALSE);
+      else if(value.is<int32_t>()) {
+        put(out, Tag::SIGNED);
+        out.put(static_cast<uint32_t>(value.as<int32_t>()));
+      } else if(value.is<uint32_t>()) {
+        put(out, Tag::UNSIGNED);
+        out.put(value.as<uint32_t>());
+      } else if(value.is<float>()) {
+        float real = value.as<float>();
+        uint32_t bits;
+        memcpy(&bits, &real, sizeof(bits));
+        put(out, Tag::REAL);
+        out.put(bits);
+      } else if(value.is<const char*>()) {
+        int32_t offset = strings.offsetOf(value.as<const char*>());
+        if(offset < 0) return false;
+        put(out, Tag::STRING);
+        out.put(static_cast<uint32_t>(offset));
+      } else if(value.isNull()) put(out, Tag::NONE);
+      else return false;
+    }
+    return true;
+  }
+
+  bool readRecord(Reader& reader, const char* strings, uint32_t stringBytes, JsonObject object) {
+    uint8_t fields = reader.get<uint8_t>();
+    if(fields > MaxFields) return false;
+    for(uint8_t i = 0; i < fields && reader; i++) {
+      uint8_t key = reader.get<uint8_t>();
+      auto tag = static_cast<Tag>(reader.get<uint8_t>());
+      if(key >= KeyCount) return false;
+      const char* name = Keys[key];
+      switch(tag) {
+        case Tag::NONE: object[name] = static_cast<const char*>(nullptr); break;
+        case Tag::BOOL_FALSE: object[name] = false; break;
+        case Tag::BOOL_TRUE: object[name] = true; break;
+        case Tag::SIGNED: object[name] = static_cast<int32_t>(reader.get<uint32_t>()); break;
+        case Tag::UNSIGNED: object[name] = reader.get<uint32_t>(); break;
+        case Tag::REAL: {
+          uint32_t bits = reader.get<uint32_t>();
+          float real;
+          memcpy(&real, &bits, sizeof(real));
+          object[name] = real;
+          break;
+        }
+        case Tag::STRING: {
+          uint32_t offset = reader.get<uint32_t>();
+          if(offset >= stringBytes) return false;               // the table ends with a terminator, any offset inside it is a string
+          object[name] = static_cast<const char*>(strings + offset);
+          break;
+        }
+        default: return false;
+      }
+    }
+    return static_cast<bool>(reader);
+  }
+
+  // Writes the loaded card. Components are serialized twice, first to collect the strings and size the records,
+  // then to write them, so only the string table is held in RAM.
+  bool save(Print& file, uint32_t layoutHash) {
+    using namespace Website;
+    CommonJsonMemory::Guard guard(WebsiteComponent::getJsonMemory(), JSON_MEMORY_WAIT_MS);
+    if(!guard) return false;
+    StringTable strings;
+    std::vector<uint16_t> counts(Card::getTypeCount());
+    Writer records(nullptr);
+    uint16_t components = 0;
+    for(WebsiteComponent* component; (component = card.getComponentById(components)) != nullptr; components++) {
+      JsonObject object = component->toWebsiteJson();
+      int16_t type = Card::getTypeIndex(object[JsonKey::ComponentType].as<const char*>());
+      if(type < 0 || !writeRecord(records, object, strings)) return false;
+      counts[type]++;
+    }
+    if(components == 0) return false;
+
+    Writer out(&file);
+    out.put(Magic);
+    out.put(FormatVersion);
+    out.put(static_cast<uint16_t>(counts.size()));
+    out.put(layoutHash);
+    out.put(components);
+    out.put(static_cast<uint32_t>(card.getArena().used()));
+    out.put(static_cast<uint32_t>(strings.size()));
+    out.put(static_cast<uint32_t>(records.count));
+    for(uint16_t count : counts) out.put(count);
+    size_t headerBytes = out.count;
+    out.write(strings.data(), strings.size());
+    for(uint16_t id = 0; id < components; id++) {
+      if(!writeRecord(out, card.getComponentById(id)->toWebsiteJson(), strings)) return false;
+    }
+    out.put(out.checksum);
+    return out.count == headerBytes + strings.size() + records.count + sizeof(uint32_t);
+  }
+
+  // Fills an empty card from a snapshot taken from the layout with layoutHash. The sizes in the header must add up to the
+  // file and the arena has to fit the largest free block before anything is allocated; a snapshot failing later leaves the card empty again.
+  Status load(Stream& file, uint32_t layoutHash) {
+    using namespace Website;
+    using JsonReader::inputJsonMemory;
+    if(!card.isEmpty()) return Status::STALE;
+    Reader reader(file);
+    uint32_t magic = reader.get<uint32_t>();
+    uint16_t version = reader.get<uint16_t>();
+    uint16_t typeCount = reader.get<uint16_t>();
+    uint32_t snapshotHash = reader.get<uint32_t>();
+    if(!reader) return Status::CORRUPT;
+    if(magic != Magic || version != FormatVersion || typeCount != Card::getTypeCount() || snapshotHash != layoutHash) return Status::STALE;
+    uint16_t components = reader.get<uint16_t>();
+    uint32_t arenaBytes = reader.get<uint32_t>();
+    uint32_t stringBytes = reader.get<uint32_t>();
+    uint32_t recordBytes = reader.get<uint32_t>();
+    std::vector<uint16_t> counts(typeCount);
+    size_t total = 0;
+    for(uint16_t& count : counts) total += count = reader.get<uint16_t>();
+    if(!reader || components == 0 || total != components || stringBytes == 0 ||
+       reader.left() != static_cast<size_t>(stringBytes) + recordBytes + sizeof(uint32_t)) return Status::CORRUPT;
+    // the arena is reserved as one block, a bigger size than any block could be is a damaged header, not a big layout
+#ifdef ESP8266
+    uint32_t maxBlock = ESP.getMaxFreeBlockSize();
+#else
+    uint32_t maxBlock = ESP.getMaxAllocHeap();
+#endif
+    if(arenaBytes > maxBlock || stringBytes > maxBlock - arenaBytes) return Status::CORRUPT;
+
+    card.reserve(counts.data(), arenaBytes + stringBytes);
+    char* strings = card.adoptStrings(stringBytes);
+    if(strings == nullptr || !JsonReader::fitMemory(inputJsonMemory, RecordCapacity)) {
+      card.garbageCollect();
+      return Status::ALLOC_ERROR;
+    }
+    Card::setJsonMemory(&inputJsonMemory);
+
+    Status status = Status::OK;
+    {
+      CommonJsonMemory::Guard guard(&inputJsonMemory, JSON_MEMORY_WAIT_MS);
+      if(!guard) status = Status::ALLOC_ERROR;
+      else if(!reader.read(strings, stringBytes) || strings[stringBytes - 1] != '\0') status = Status::CORRUPT;
+      for(uint16_t id = 0; id < components && status == Status::OK; id++) {
+        JsonObject object = inputJsonMemory.get()->to<JsonObject>();
+        // Card::add() reports only a missing name or type, a component which did not build is missing from the card
+        if(!readRecord(reader, strings, stringBytes, object) || inputJsonMemory.get()->overflowed() ||
+           card.add(object) != Card::ComponentStatus::OK || card.getComponentById(id) == nullptr) status = Status::CORRUPT;
+      }
+    }
+    uint32_t checksum = reader.checksum;
+    if(status == Status::OK && (reader.get<uint32_t>() != checksum || !reader)) status = Status::CORRUPT;
+    if(status == Status::OK && JsonReader::fitOutputMemory() != JsonReader::InputJsonStatus::OK) status = Status::ALLOC_ERROR;
+    if(status != Status::OK) card.garbageCollect();
+    return status;
+  }
+
+  const char* statusMessage(Status status) {
+    using namespace ErrorMessage::Snapshot;
+    switch (status) {
+      case Status::OK: return Loaded;
+      case Status::MISSING: return Missing;
+      case Status::STALE: return Stale;
+      case Status::CORRUPT: return Corrupt;
+      case Status::ALLOC_ERROR: return AllocError;
+    }
+    return Corrupt;
+  }
+
+  // The layout at boot: from the snapshot when it was taken from the same layout text and firmware, otherwise parsed -
+  // from LayoutPath when present, else the built-in one - and snapshotted for the next boot
+  JsonReader::InputJsonStatus bootLayout() {
+    using JsonReader::InputJsonStatus;
+    File layoutFile;
+    uint32_t hashed;
+    if(SPIFFS.exists(LayoutPath)) {
+      layoutFile = SPIFFS.open(LayoutPath);
+      hashed = layoutHash(layoutFile);
+      layoutFile.seek(0);
+    } else hashed = layoutHash(testWebsiteConfigStr);
+
+    Status loaded = Status::MISSING;
+    if(SPIFFS.exists(SnapshotPath)) {
+      File snapshot = SPIFFS.open(SnapshotPath);
+      loaded = load(snapshot, hashed);
+      snapshot.close();
+    }
+    Log::info(statusMessage(loaded));
+
+    InputJsonStatus status = InputJsonStatus::OK;
+    if(loaded != Status::OK) {
+      status = layoutFile ? JsonReader::readWebsiteComponentsFromStream(layoutFile) : JsonReader::loadLayout(std::move(testWebsiteConfigStr));
+      if(status == InputJsonStatus::OK) {
+        File snapshot = SPIFFS.open(SnapshotPath, FILE_WRITE);
+        bool saved = snapshot && save(snapshot, hashed);
+        snapshot.close();
+        if(!saved) {
+          SPIFFS.remove(SnapshotPath);                          // a partial file would only be rejected at every boot
+          Log::error(ErrorMessage::Snapshot::SaveFailed);
+        }
+      }
+    }
+    if(layoutFile) layoutFile.close();
+    testWebsiteConfigStr.clear();
+    return status;
+  }
+}
+
+// Counters for /metrics, Prometheus text format. Handlers on the AsyncTCP task and loop() update them with relaxed atomic adds:
+// no allocation, no lock. Histogram buckets are counted on their own and added up when scraped.
+namespace Metrics {
+  enum class Route : uint8_t {INPUTS, STATUS, ASSETS};
+  const char* RouteLabels[] = {"/input", "/status", "assets"};
+  const size_t RouteCount = sizeof(RouteLabels) / sizeof(RouteLabels[0]);
+
+  struct Bucket {
+    uint32_t us;                                                // upper bound
+    const char* le;                                             // the same in seconds, as exposed
+  };
+  const Bucket Buckets[] = {
+    {100, "0.0001"}, {250, "0.00025"}, {500, "0.0005"}, {1000, "0.001"}, {2500, "0.0025"},
+    {5000, "0.005"}, {10000, "0.01"}, {25000, "0.025"}, {50000, "0.05"}, {100000, "0.1"},
+    {250000, "0.25"}, {500000, "0.5"}, {1000000, "1"}, {2500000, "2.5"},
+  };
+  const size_t BucketCount = sizeof(Buckets) / sizeof(Buckets[0]);
+
+  class Histogram {
+  public:
+    void record(uint32_t us) {
+      size_t bucket = 0;
+      while(bucket < BucketCount && us > Buckets[bucket].us) bucket++;
+      counts[bucket].fetch_add(1, std::memory_order_relaxed);
+      // 64-bit sum from two words, the add that wraps the low word carries into the high one
+      uint32_t low = sumLow.fetch_add(us, std::memory_order_relaxed);
+      if(low + us < low) sumHigh.fetch_add(1, std::memory_order_relaxed);
+    }
+    void print(Print& out, const char* name, const char* labels) const {
+      uint32_t cumulative = 0;
+      for(size_t i = 0; i <= BucketCount; i++) {
+        cumulative += counts[i].load(std::memory_order_relaxed);
+        out.printf("%s_bucket{%s%sle=\"%s\"} %lu\n", name, labels, *labels ? "," : "", i < BucketCount ? Buckets[i].le : "+Inf",
+                   static_cast<unsigned long>(cumulative));
+      }
+      const char* open = *labels ? "{" : "";
+      const char* close = *labels ? "}" : "";
+      out.printf("%s_sum%s%s%s %.6f\n", name, open, labels, close, this->sumUs() / 1e6);
+      out.printf("%s_count%s%s%s %lu\n", name, open, labels, close, static_cast<unsigned long>(cumulative));
+    }
+  private:
+    // read while requests go on, a carry still on its way shows for one scrape at most
+    uint64_t sumUs() const {
+      uint32_t high, low;
+      do {
+        high = sumHigh.load(std::memory_order_relaxed);
+        low = sumLow.load(std::memory_order_relaxed);
+      } while(high != sumHigh.load(std::memory_order_relaxed));
+      return (static_cast<uint64_t>(high) << 32) | low;
+    }
+    std::atomic<uint32_t> counts[BucketCount + 1] {};           // the last one is +Inf
+    std::atomic<uint32_t> sumLow {0};
+    std::atomic<uint32_t> sumHigh {0};
+  };
+
+  enum class Lane : uint8_t {CONTROL, STATE, LOG};             // serial output, in priority order
+  const char* LaneLabels[] = {"control", "state", "log"};
+  const size_t LaneCount = sizeof(LaneLabels) / sizeof(LaneLabels[0]);
+
+  Histogram requests[RouteCount];
+  std::atomic<uint32_t> busy[RouteCount] {};                    // 204 answers, JSON memory held by someone else
+  Histogram loopTime;
+  std::atomic<uint32_t> eventsEmitted {0};
+  Histogram serialDelay[LaneCount];                             // from a message being ready to its last byte handed to the UART
+  std::atomic<uint32_t> serialBytes[LaneCount] {};
+
+  void markBusy(Route route) {busy[static_cast<size_t>(route)].fetch_add(1, std::memory_order_relaxed);}
+  void recordLoop(uint32_t us) {loopTime.record(us);}
+  void countEvent() {eventsEmitted.fetch_add(1, std::memory_order_relaxed);}
+  void recordSerial(Lane lane, uint32_t delayUs, size_t bytes) {
+    serialDelay[static_cast<size_t>(lane)].record(delayUs);
+    serialBytes[static_cast<size_t>(lane)].fetch_add(bytes, std::memory_order_relaxed);
+  }
+
+  // Times a handler from here to the end of the scope. For a streamed response that is the setup, not the transfer.
+  class RequestTimer {
+  public:
+    explicit RequestTimer(Route route) : route(route), start(micros()) {}
+    ~RequestTimer() {requests[static_cast<size_t>(route)].record(micros() - start);}
+  private:
+    Route route;
+    uint32_t start;
+  };
+
+  void print(Print& out) {
+    char labels[24];
+    out.print("# TYPE visuino_http_request_duration_seconds histogram\n");
+    for(size_t i = 0; i < RouteCount; i++) {
+      snprintf(labels, sizeof(labels), "route=\"%s\"", RouteLabels[i]);
+      requests[i].print(out, "visuino_http_request_duration_seconds", labels);
+    }
+    out.print("# TYPE visuino_http_busy_responses_total counter\n");
+    for(size_t i = 0; i < RouteCount; i++) {
+      out.printf("visuino_http_busy_responses_total{route=\"%s\"} %lu\n", RouteLabels[i],
+                 static_cast<unsigned long>(busy[i].load(std::memory_order_relaxed)));
+    }
+    out.print("# TYPE visuino_loop_duration_seconds histogram\n");
+    loopTime.print(out, "visuino_loop_duration_seconds", "");
+    out.print("# TYPE visuino_serial_queue_delay_seconds histogram\n");
+    for(size_t i = 0; i < LaneCount; i++) {
+      snprintf(labels, sizeof(labels), "lane=\"%s\"", LaneLabels[i]);
+      serialDelay[i].print(out, "visuino_serial_queue_delay_seconds", labels);
+    }
+    out.print("# TYPE visuino_serial_bytes_total counter\n");
+    for(size_t i = 0; i < LaneCount; i++) {
+      out.printf("visuino_serial_bytes_total{lane=\"%s\"} %lu\n", LaneLabels[i],
+                 static_cast<unsigned long>(serialBytes[i].load(std::memory_order_relaxed)));
+    }
+    const struct {
+      const char* name;
+      uint32_t value;
+    } events[] = {
+      {"visuino_events_emitted_total", eventsEmitted.load(std::memory_order_relaxed)},
+      {"visuino_events_coalesced_total", Visuino::queue.coalescedCount()},
+      {"visuino_events_dropped_total", Visuino::queue.droppedCount()},
+    };
+    for(const auto& counter : events) {
+      out.printf("# TYPE %s counter\n%s %lu\n", counter.name, counter.name, static_cast<unsigned long>(counter.value));
+    }
+    out.printf("# TYPE visuino_heap_free_bytes gauge\nvisuino_heap_free_bytes %lu\n", static_cast<unsigned long>(ESP.getFreeHeap()));
+#ifdef ESP32
+    out.printf("# TYPE visuino_heap_largest_free_block_bytes gauge\nvisuino_heap_largest_free_block_bytes %lu\n",
+               static_cast<unsigned long>(ESP.getMaxAllocHeap()));
+#endif
+#ifdef ESP8266
+    out.printf("# TYPE visuino_heap_largest_free_block_bytes gauge\nvisuino_heap_largest_free_block_bytes %lu\n",
+               static_cast<unsigned long>(ESP.getMaxFreeBlockSize()));
+#endif
+  }
+}
+
 namespace JsonWriter{
-  void write() {
+  void writeEvent(Print& out, const Visuino::Event& event) {
     using namespace Website;
-    if(Log::isDataReady){
-      //LogOutput.Send(Log::errorStream.c_str());
-      Serial.println(Log::errorStream.c_str());
-      Log::errorStream.clear();
-      Log::isDataReady = false;
+    if(Visuino::linkFormat == Visuino::LinkFormat::BINARY) {
+      uint8_t frame[Visuino::MaxFrameSize];
+      out.write(frame, Visuino::encodeFrame(event, frame));
+      Metrics::countEvent();
+      return;
     }
-    if(Switch::isDataReady){
-      Serial.println(Switch::getVisuinoOutput());
-      //ServerSwitchOutput.Send(Switch::toString());
-      Switch::isDataReady = false;
+    WebsiteComponent* component = card.getComponentById(event.id);
+    if(component == nullptr) return;
+    StaticJsonDocument<JSON_OBJECT_SIZE(2)> doc;
+    doc[JsonKey::Name] = component->getName();
+    switch (event.type) {
+      case Visuino::TypeTag::SWITCH:
+      case Visuino::TypeTag::BUTTON:
+        doc[JsonKey::Value] = event.value != 0;
+        break;
+      case Visuino::TypeTag::SLIDER:
+        doc[JsonKey::Value] = event.value;
+        break;
+      case Visuino::TypeTag::NUMBER_INPUT:
+        doc[JsonKey::Value] = Visuino::unpackFloat(event.value);
+        break;
     }
-    if(Slider::isDataReady){
-      Serial.println(Slider::getVisuinoOutput());
-      Slider::isDataReady = false;
+    serializeJson(doc, out);
+    out.println();
+    Metrics::countEvent();
+  }
+}
+
+// The Visuino serial link, serviced from loop() without blocking: each call hands the UART no more than Serial.availableForWrite().
+// Messages come from three lanes in priority order - control events from the EventQueue, input state which only needs its latest value
+// (parked overflow values and /ws drags) and the log. A message is formatted when its turn comes and leaves whole before the next one
+// starts, so lanes never interleave, and a control event waits at most for the one message already on its way.
+namespace SerialOutput {
+  const uint8_t MaxMessageLength = 128;
+
+  // One message on its way to the link. A message longer than the buffer (a very long component name) goes to the link directly
+  // as it is written, which may block - nothing else is on its way then.
+  class MessageBuffer : public Print {
+  public:
+    explicit MessageBuffer(Print& link) : link(link) {}
+    size_t write(uint8_t c) override {return write(&c, 1);}
+    size_t write(const uint8_t* data, size_t size) override {
+      if(!overflowed && length + size > MaxMessageLength) {
+        overflowed = true;
+        link.write(bytes, length);
+      }
+      if(overflowed) link.write(data, size);
+      else memcpy(bytes + length, data, size);
+      length += size;
+      if(overflowed) sent = length;
+      return size;
     }
-    if(NumberInput::isDataReady) {
-      Serial.println(NumberInput::getVisuinoOutput());
-      NumberInput::isDataReady = false;
+    using Print::write;
+
+    void start(Metrics::Lane lane, uint32_t queuedAt) {
+      this->lane = lane;
+      this->queuedAt = queuedAt;
+      length = sent = 0;
+      overflowed = false;
     }
-    if(Button::isDataReady){
-      Serial.println(Button::getVisuinoOutput());
-      Button::isDataReady = false;
+    bool isSent() const {return sent == length;}
+    bool isOverflowed() const {return overflowed;}
+    // hands out up to budget bytes, the delay is recorded once the last one went
+    size_t send(size_t budget) {
+      size_t count = std::min<size_t>(budget, length - sent);
+      if(count > 0) link.write(bytes + sent, count);
+      sent += count;
+      if(isSent()) Metrics::recordSerial(lane, micros() - queuedAt, length);
+      return count;
     }
+
+  private:
+    Print& link;
+    uint8_t bytes[MaxMessageLength];
+    size_t length = 0;
+    size_t sent = 0;
+    bool overflowed = false;
+    Metrics::Lane lane = Metrics::Lane::CONTROL;
+    uint32_t queuedAt = 0;
+  };
+
+  MessageBuffer message {Serial};
+
+  // formats an event into message, false if nothing is left to send
+  bool stage(Metrics::Lane lane, const Visuino::Event& event, uint32_t queuedAt) {
+    message.start(lane, queuedAt);
+    JsonWriter::writeEvent(message, event);
+    if(message.isOverflowed()) message.send(0);                // out already, records the delay
+    return !message.isSent();
+  }
+
+  // the highest priority message waiting, false once every lane is empty
+  bool next() {
+    using namespace Website;
+    Visuino::Event event;
+    uint32_t queuedAt;
+    while(Visuino::queue.pop(event, &queuedAt)) {
+      if(stage(Metrics::Lane::CONTROL, event, queuedAt)) return true;
+    }
+    while(card.takeStateInput(event, queuedAt)) {
+      if(stage(Metrics::Lane::STATE, event, queuedAt)) return true;
+    }
+    char line[Log::MaxLineLength];
+    uint32_t timeMs;
+    size_t length = Log::take(line, sizeof(line), timeMs);
+    if(length == 0) return false;
+    message.start(Metrics::Lane::LOG, timeMs * 1000);
+    message.write(reinterpret_cast<const uint8_t*>(line), length);
+    return true;
+  }
+
+  // called from loop()
+  void service() {
+    int room = Serial.availableForWrite();
+    size_t budget = room > 0 ? room : 0;
+    while(budget > 0 && (!message.isSent() || next())) budget -= message.send(budget);
   }
 }
 
 
+// Pushes output component changes to /events clients, called from loop().
+// Changes between two ticks coalesce in the card versions, so a component updated many times is sent once with its latest state.
+// Clients which do not keep up are not fed further - the library drops messages above its queue limit -
+// and a burst bigger than one tick's budget is replaced by a single resync event pointing to /input?since=.
+namespace Events {
+  const uint8_t MaxEventsPerTick PROGMEM = 16;
+  const uint8_t MaxPacketsWaiting PROGMEM = 8;
+  const char* StateEvent PROGMEM = "state";
+  const char* ResyncEvent PROGMEM = "resync";
+
+  uint32_t pushedVersion = 0;
+  String message;
+
+  void sendResync(AsyncEventSourceClient* client, uint32_t since) {
+    char data[32];
+    snprintf(data, sizeof(data), "{\"since\":%lu}", static_cast<unsigned long>(since));
+    if(client != nullptr) client->send(data, ResyncEvent, card.getVersion());
+    else events.send(data, ResyncEvent, card.getVersion());
+  }
 
-void fullCorsAllow(AsyncWebServerResponse* response){
-  response->addHeader(CORS_HEADER_ACCESS_CONTROL_ALLOW_ORIGIN, "*");
-  response->addHeader(CORS_HEADER_ACCESS_CONTROL_ALLOW_METHODS, CORS_ALLOWED_METHODS);
-  response->addHeader(CORS_HEADER_ACCESS_CONTROL_ALLOW_HEADERS, CORS_ALLOWED_HEADERS);
+  void publish() {
+    using namespace Website;
+    uint32_t version = card.getVersion();
+    if(version == pushedVersion) return;
+    if(events.count() == 0) {
+      pushedVersion = version;
+      return;
+    }
+    if(events.avgPacketsWaiting() > MaxPacketsWaiting) return;
+    CommonJsonMemory::Guard guard(WebsiteComponent::getJsonMemory());
+    if(!guard) return;                                            // busy, the changes are picked up on the next tick
+
+    uint16_t changed = 0;
+    card.forEachChangedOutput(pushedVersion, [&changed] (OutputComponent*) {return ++changed <= MaxEventsPerTick;});
+    if(changed > MaxEventsPerTick) {
+      sendResync(nullptr, pushedVersion);
+    } else if(changed > 0) {
+      card.forEachChangedOutput(pushedVersion, [version] (OutputComponent* component) {
+        message.clear();
+        serializeJson(component->toStateJson(), message);
+        events.send(message.c_str(), StateEvent, version);
+        return true;
+      });
+    }
+    pushedVersion = version;
+  }
 }
 
-void HTTPServeWebsite(AsyncWebServer& webServer){
 
-  webServer.on("/", HTTP_GET, [](AsyncWebServerRequest* request){
-    request->send(SPIFFS, "/index.html");
-  });
+// Website files in SPIFFS, each stored gzipped as <path>.gz (gzip -9 -n), plain, or both. A client accepting gzip gets the .gz
+// with Content-Encoding: gzip, the plain file is for clients without gzip when it is stored. Responses carry a strong ETag
+// of the stored bytes and a matching If-None-Match is answered with 304 without reading anything.
+// At the first boot after the SPIFFS image was uploaded the stored files are packed into one bundle - an upload replaces the
+// whole image, so a bundle never outlives the files it was packed from. Bundle, multi-byte fields little endian:
+//   magic "VUIA" (4) | format version (2) | entries (2), then per entry:
+//   path length (1) | path | gzip (1) | offset (4) | length (4) | FNV-1a of the content (4), then the contents back to back
+// Requests are answered from the bundle, kept open, with a seek. Small files requested again are kept in RAM.
+// Without a bundle - no room to pack it - the files are served one by one.
+namespace Assets {
+  const char* NoCache PROGMEM = "no-cache";
+  const char* LongLived PROGMEM = "public, max-age=" ASSET_TO_STRING(ASSET_MAX_AGE);
+  const char* GzipSuffix PROGMEM = ".gz";
+  const char* BundlePath PROGMEM = "/assets.bin";
+  const uint32_t BundleMagic = 0x41495556;                      // "VUIA"
+  const uint16_t BundleVersion = 1;
+
+  struct Asset {
+    const char* uri;
+    const char* path;
+    const char* contentType;
+    const char* cacheControl;
+  };
+  const Asset Files[] = {
+    {"/",                    "/index.html",          "text/html",              NoCache},
+    {"/index.css",           "/index.css",           "text/css",               LongLived},
+    {"/index.js",            "/index.js",            "application/javascript", LongLived},
+    {"/component.css",       "/component.css",       "text/css",               LongLived},
+    {"/component.js",        "/component.js",        "application/javascript", LongLived},
+    {"/Libs/pureknobMin.js", "/Libs/pureknobMin.js", "application/javascript", LongLived},
+    {"/favicon.ico",         "/favicon.ico",         "image/ico",              LongLived},
+  };
+  const size_t FileCount = sizeof(Files) / sizeof(Files[0]);
+
+  // one stored variant of a file
+  struct Stored {
+    String etag;                                                // empty when the variant is not stored
+    uint32_t hash = 0;
+    uint32_t offset = 0;                                        // in the bundle
+    uint32_t length = 0;
+    uint32_t hits = 0;
+    std::shared_ptr<uint8_t> cached;                            // responses being sent keep it alive after an eviction
+  };
+  struct Variants {
+    Stored gzip;
+    Stored plain;
+  };
+  Variants variants[FileCount];
+  File bundle;                                                  // only read from the async TCP task, every fill seeks first
+  size_t cacheCapacity = ASSET_CACHE_BYTES;
+  size_t cacheUsed = 0;
 
-  webServer.on("/index.css", HTTP_GET, [](AsyncWebServerRequest *request){
-    request->send(SPIFFS, "/index.css","text/css");
-  });
+  String storedPath(const Asset& asset, bool gzip) {
+    return gzip ? String(asset.path) + GzipSuffix : String(asset.path);
+  }
 
-  webServer.on("/index.js", HTTP_GET, [](AsyncWebServerRequest *request){
-    request->send(SPIFFS, "/index.js","application/javascript");
-  });
+  void describe(Stored& stored, uint32_t hash, uint32_t length) {
+    char tag[12];
+    snprintf(tag, sizeof(tag), "\"%08lx\"", static_cast<unsigned long>(hash));
+    stored.etag = tag;
+    stored.hash = hash;
+    stored.length = length;
+  }
 
-  webServer.on("/component.css", HTTP_GET, [](AsyncWebServerRequest *request){
-    request->send(SPIFFS, "/component.css","text/css");
-  });
+  void scanFiles() {
+    for(size_t i = 0; i < FileCount; i++) {
+      variants[i] = Variants();
+      for(bool gzip : {true, false}) {
+        String path = storedPath(Files[i], gzip);
+        if(!SPIFFS.exists(path)) continue;
+        File file = SPIFFS.open(path);
+        if(file) describe(gzip ? variants[i].gzip : variants[i].plain, Binary::hash(file), file.size());
+      }
+    }
+  }
 
-  webServer.on("/component.js", HTTP_GET, [](AsyncWebServerRequest *request){
-    request->send(SPIFFS, "/component.js","application/javascript");
-#ifdef DEBUG_MODE
-    Log::info("Component", Serial);
-    Log::memoryInfo(Serial);
-#endif
-  });
+  // Reads the index of the bundle, false when there is none or it does not fit the file
+  bool loadBundle() {
+    bundle = SPIFFS.open(BundlePath);
+    if(!bundle) return false;
+    size_t size = bundle.size();
+    Binary::Reader reader(bundle);
+    bool valid = reader.get<uint32_t>() == BundleMagic && reader.get<uint16_t>() == BundleVersion;
+    uint16_t entries = reader.get<uint16_t>();
+    for(uint16_t entry = 0; valid && entry < entries; entry++) {
+      char path[64];
+      uint8_t length = reader.get<uint8_t>();
+      valid = length < sizeof(path) && reader.read(path, length);
+      path[valid ? length : 0] = '\0';
+      bool gzip = reader.get<uint8_t>() != 0;
+      uint32_t offset = reader.get<uint32_t>();
+      uint32_t contentLength = reader.get<uint32_t>();
+      uint32_t hash = reader.get<uint32_t>();
+      valid = valid && reader && contentLength <= size && offset <= size - contentLength;
+      for(size_t i = 0; valid && i < FileCount; i++) {
+        if(strcmp(Files[i].path, path)) continue;               // files the firmware no longer serves stay unused
+        Stored& stored = gzip ? variants[i].gzip : variants[i].plain;
+        describe(stored, hash, contentLength);
+        stored.offset = offset;
+      }
+    }
+    if(!valid) bundle.close();
+    return valid;
+  }
+
+  // Packs the variants scanFiles() found, their contents are copied in a second pass over the files
+  bool pack() {
+    File out = SPIFFS.open(BundlePath, FILE_WRITE);
+    if(!out) return false;
+    uint16_t entries = 0;
+    uint32_t offset = 8;
+    for(size_t i = 0; i < FileCount; i++) {
+      for(const Stored* stored : {&variants[i].gzip, &variants[i].plain}) {
+        if(stored->etag.isEmpty()) continue;
+        entries++;
+        offset += 1 + strlen(Files[i].path) + 1 + 12;
+      }
+    }
+    Binary::Writer writer(&out);
+    writer.put(BundleMagic);
+    writer.put(BundleVersion);
+    writer.put(entries);
+    for(size_t i = 0; i < FileCount; i++) {
+      for(bool gzip : {true, false}) {
+        const Stored& stored = gzip ? variants[i].gzip : variants[i].plain;
+        if(stored.etag.isEmpty()) continue;
+        uint8_t length = strlen(Files[i].path);
+        writer.put(length);
+        writer.write(reinterpret_cast<const uint8_t*>(Files[i].path), length);
+        writer.put(static_cast<uint8_t>(gzip));
+        writer.put(offset);
+        writer.put(stored.length);
+        writer.put(stored.hash);
+        offset += stored.length;
+      }
+    }
+    for(size_t i = 0; i < FileCount; i++) {
+      for(bool gzip : {true, false}) {
+        if((gzip ? variants[i].gzip : variants[i].plain).etag.isEmpty()) continue;
+        File file = SPIFFS.open(storedPath(Files[i], gzip));
+        uint8_t buffer[256];
+        size_t count;
+        while((count = file.read(buffer, sizeof(buffer))) > 0) writer.write(buffer, count);
+      }
+    }
+    out.close();
+    if(writer.count == offset && entries > 0) return true;
+    SPIFFS.remove(BundlePath);
+    return false;
+  }
+
+  // Called from ServerInit(): the index of the bundle, packed first when missing or damaged
+  void begin() {
+    bundle.close();
+    for(Variants& stored : variants) stored = Variants();
+    cacheUsed = 0;
+    if(loadBundle()) return;
+    if(SPIFFS.exists(BundlePath)) SPIFFS.remove(BundlePath);
+    scanFiles();
+    if(pack() && !loadBundle()) scanFiles();
+  }
 
-  webServer.on("/Libs/pureknobMin.js", HTTP_GET, [](AsyncWebServerRequest *request){
-    request->send(SPIFFS, "/Libs/pureknobMin.js","application/javascript");
+  // Counts a request and keeps a small variant in RAM from its second request on, evicting colder ones when the cache is full
+  void touch(Stored& variant) {
+    variant.hits++;
+    if(variant.cached || variant.hits < 2 || variant.length == 0 || variant.length > cacheCapacity / 4) return;
+    while(cacheUsed + variant.length > cacheCapacity) {
+      Stored* coldest = nullptr;
+      for(Variants& stored : variants) {
+        for(Stored* candidate : {&stored.gzip, &stored.plain}) {
+          if(candidate->cached && (coldest == nullptr || candidate->hits < coldest->hits)) coldest = candidate;
+        }
+      }
+      if(coldest == nullptr || coldest->hits >= variant.hits) return;
+      coldest->cached.reset();
+      cacheUsed -= coldest->length;
+    }
+    std::shared_ptr<uint8_t> block(new (std::nothrow) uint8_t[variant.length], std::default_delete<uint8_t[]>());
+    if(!block || !bundle.seek(variant.offset) || bundle.read(block.get(), variant.length) != variant.length) return;
+    variant.cached = block;
+    cacheUsed += variant.length;
+  }
+
+  AwsResponseFiller bundleFiller(Stored& variant) {
+    touch(variant);
+    uint32_t offset = variant.offset;
+    uint32_t length = variant.length;
+    std::shared_ptr<uint8_t> cached = variant.cached;
+    if(cached) {
+      return [cached, length] (uint8_t* buffer, size_t maxLen, size_t index) -> size_t {
+        size_t count = index < length ? std::min<size_t>(maxLen, length - index) : 0;
+        memcpy(buffer, cached.get() + index, count);
+        return count;
+      };
+    }
+    return [offset, length] (uint8_t* buffer, size_t maxLen, size_t index) -> size_t {
+      size_t count = index < length ? std::min<size_t>(maxLen, length - index) : 0;
+      if(count == 0 || !bundle.seek(offset + index)) return 0;
+      return bundle.read(buffer, count);
+    };
+  }
+
+  // gzip anywhere in Accept-Encoding, unless refused with q=0
+  bool acceptsGzip(AsyncWebServerRequest* request) {
+    String accepted = request->header("Accept-Encoding");
+    int at = accepted.indexOf("gzip");
+    if(at < 0) return false;
+    int end = accepted.indexOf(',', at);
+    String params = accepted.substring(at, end < 0 ? accepted.length() : end);
+    int quality = params.indexOf("q=");
+    return quality < 0 || params.substring(quality + 2).toFloat() > 0;
+  }
+
+  // If-None-Match lists one or more tags, weak ones included, or is *
+  bool isCached(AsyncWebServerRequest* request, const String& etag) {
+    String tags = request->header("If-None-Match");
+    return tags == "*" || (!tags.isEmpty() && tags.indexOf(etag) >= 0);
+  }
+
+  void send(AsyncWebServerRequest* request, const Asset& asset, Variants& stored) {
+    bool gzip = !stored.gzip.etag.isEmpty() && (stored.plain.etag.isEmpty() || acceptsGzip(request));
+    Stored& variant = gzip ? stored.gzip : stored.plain;
+    if(variant.etag.isEmpty()) {
+      request->send(HTTP_STATUS_NOT_FOUND);
+      return;
+    }
+    AsyncWebServerResponse* response;
+    if(isCached(request, variant.etag)) response = request->beginResponse(HTTP_STATUS_NOT_MODIFIED);
+    else {
+      if(bundle) response = request->beginResponse(asset.contentType, variant.length, bundleFiller(variant));
+      // an existing path is served as it is, the library adds Content-Encoding only when it falls back to the .gz itself
+      else response = request->beginResponse(SPIFFS, storedPath(asset, gzip), asset.contentType);
+      if(gzip) response->addHeader("Content-Encoding", "gzip");
+    }
+    response->addHeader("ETag", variant.etag);
+    response->addHeader("Cache-Control", asset.cacheControl);
+    if(!stored.gzip.etag.isEmpty() && !stored.plain.etag.isEmpty()) response->addHeader("Vary", "Accept-Encoding");
+    request->send(response);
+  }
+}
+
+// A body spanning several TCP segments reaches the body handler piece by piece (index, total). It is copied into a buffer
+// hung on the request as _tempObject, which the library frees with the request; onDisconnect, called for every request
+// that ends, gives its bytes back to the budget. A body in one segment is used where it is.
+namespace BodyBuffer {
+  size_t reserved = 0;                                          // only touched from the AsyncTCP task
+
+  // The whole body once its last segment arrived, nullptr before and for a refused body - answered on its first segment
+  const uint8_t* collect(AsyncWebServerRequest* request, const uint8_t* data, size_t len, size_t index, size_t total) {
+    if(index == 0 && len == total) return data;
+    if(index == 0) {
+      if(total > BODY_BUFFER_BUDGET - reserved) {
+        request->send(HTTP_STATUS_PAYLOAD_TOO_LARGE);
+        return nullptr;
+      }
+      request->_tempObject = malloc(total);
+      if(request->_tempObject == nullptr) {
+        request->send(HTTP_STATUS_INTERNAL_SERVER_ERROR);
+        return nullptr;
+      }
+      reserved += total;
+      request->onDisconnect([total] () {reserved -= total;});
+    }
+    auto buffer = static_cast<uint8_t*>(request->_tempObject);
+    if(buffer == nullptr || index + len > total) return nullptr;
+    memcpy(buffer + index, data, len);
+    return index + len == total ? buffer : nullptr;
+  }
+}
+
+
+void fullCorsAllow(AsyncWebServerResponse* response){
+  response->addHeader(CORS_HEADER_ACCESS_CONTROL_ALLOW_ORIGIN, "*");
+  response->addHeader(CORS_HEADER_ACCESS_CONTROL_ALLOW_METHODS, CORS_ALLOWED_METHODS);
+  response->addHeader(CORS_HEADER_ACCESS_CONTROL_ALLOW_HEADERS, CORS_ALLOWED_HEADERS);
+}
+
+void HTTPServeWebsite(AsyncWebServer& webServer){
+  Assets::begin();
+  for(size_t i = 0; i < Assets::FileCount; i++) {
+    webServer.on(Assets::Files[i].uri, HTTP_GET, [i](AsyncWebServerRequest* request){
+      Metrics::RequestTimer timer(Metrics::Route::ASSETS);
+      Assets::send(request, Assets::Files[i], Assets::variants[i]);
 #ifdef DEBUG_MODE
-    Log::info("Knob", Serial);
-    Log::memoryInfo(Serial);
+      Log::info(Assets::Files[i].uri);
+      Log::memoryInfo(Serial);
 #endif
+    });
+  }
+}
+
+void HTTPSetEvents(AsyncWebServer& webServer){
+  // a (re)connecting browser gets the version to continue from, Last-Event-ID = 0 means it needs the whole layout
+  events.onConnect([] (AsyncEventSourceClient* client){
+    Events::sendResync(client, client->lastId());
   });
+  webServer.addHandler(&events);
+}
 
-  webServer.on("/favicon.ico", HTTP_GET, [](AsyncWebServerRequest *request){
-      request->send(SPIFFS, "/favicon.ico","image/ico");
+void HTTPSetWebSocket(AsyncWebServer& webServer){
+  // same JSON messages as /status over one persistent connection, one message per text frame
+  ws.onEvent([] (AsyncWebSocket* server, AsyncWebSocketClient* client, AwsEventType type, void* arg, uint8_t* data, size_t len){
+    using namespace Website;
+    if(type != WS_EVT_DATA) return;
+    auto info = reinterpret_cast<AwsFrameInfo*>(arg);
+    if(!info->final || info->index != 0 || info->len != len || info->opcode != WS_TEXT) {
+      Log::error("Fragmented websocket message ignored");
+      return;
+    }
+    CommonJsonMemory::Guard guard(Card::getOutputJsonMemory(), JSON_MEMORY_WAIT_MS);
+    if(!guard) {
+      Log::error("Output memory busy, websocket message dropped");
+      return;
+    }
+    if(!card.onComponentStatusWebSocketMessage(data, len)){
+      Log::error("Error while parsing input component");
+    }
   });
+  webServer.addHandler(&ws);
 }
 
 void HTTPSetMappings(AsyncWebServer& webServer){
@@ -1576,42 +3900,82 @@ void HTTPSetMappings(AsyncWebServer& webServer){
 
   webServer.on("/input", HTTP_GET, [] (AsyncWebServerRequest* request){
     using namespace Website;
+    Metrics::RequestTimer timer(Metrics::Route::INPUTS);
 #ifdef DEBUG_BUILD
     Log::info("Proccessing info request");
 #endif
-    if(Card::isMemoryReadyToUse()) {
+    // held only while the request is set up, a layout being parsed answers 204
+    CommonJsonMemory::Guard guard(Card::getJsonMemory(), JSON_MEMORY_WAIT_MS);
+    if(guard) {
 #ifdef DEBUG_BUILD
       Log::info("mem ok, request resolved");
 #endif
-      Card::lockJsonMemory();
-      static String responseBody;   // static to avoid heap allocation in every request - beginResponse takes const reference
-      responseBody.clear();
-      serializeJson(card.onHTTPRequest()[JsonKey::Body], responseBody);
-      AsyncWebServerResponse* response = request->beginResponse(HTTP_STATUS_OK, "application/json", responseBody);
+      std::shared_ptr<Card::ResponseCursor> cursor(new Card::ResponseCursor());
+      if(request->hasParam(HTTP_PARAM_SINCE)) {
+        cursor->since = strtoul(request->getParam(HTTP_PARAM_SINCE)->value().c_str(), nullptr, 10);
+      }
+      // streamed straight from the components, neither the main JSON memory nor a response string is used
+      AsyncWebServerResponse* response = request->beginChunkedResponse("application/json",
+              [cursor] (uint8_t* buffer, size_t maxLen, size_t index) -> size_t {
+        return card.fillHTTPResponse(*cursor, buffer, maxLen);
+      });
       fullCorsAllow(response);
       request->send(response);
-      Card::releaseJsonMemory();
     } else {
 #ifdef DEBUG_BUILD
       Log::info("mem locked, no content");
 #endif
+      Metrics::markBusy(Metrics::Route::INPUTS);
       request->send(HTTP_STATUS_OK_NO_CONTENT);
     }
   });
 
   webServer.on("/status", HTTP_POST, [] (AsyncWebServerRequest* request){}, nullptr,
-          [](AsyncWebServerRequest * request, uint8_t *data, size_t len, size_t index, size_t total) {
+          [](AsyncWebServerRequest * request, uint8_t *segment, size_t segmentLength, size_t index, size_t total) {
     using namespace Website;
-    if(Card::isOutputMemoryReadyToUse()){
-      Card::lockOutputJsonMemory();
+    const uint8_t* data = BodyBuffer::collect(request, segment, segmentLength, index, total);
+    if(data == nullptr) return;
+    size_t len = total;
+    Metrics::RequestTimer timer(Metrics::Route::STATUS);
+    CommonJsonMemory::Guard guard(Card::getOutputJsonMemory(), JSON_MEMORY_WAIT_MS);
+    size_t start = 0;
+    while(start < len && isspace(data[start])) start++;
+    if(guard && start < len && data[start] == '['){
+      // one status per message, in order: 200 applied, 400 invalid or no such input, 413 past Card::MaxStatusBatch
+      uint16_t results[Card::MaxStatusBatch];
+      size_t count = card.onComponentStatusBatch(data, len, results);
+      String body;
+      body.reserve(count * 4 + 2);
+      body += '[';
+      for(size_t i = 0; i < count; i++) {
+        if(i > 0) body += ',';
+        body += i < Card::MaxStatusBatch ? results[i] : HTTP_STATUS_PAYLOAD_TOO_LARGE;
+      }
+      body += ']';
+      request->send(HTTP_STATUS_OK, "application/json", body);
+    } else if(guard){
       if(card.onComponentStatusHTTPRequest(data, len)){
         request->send(HTTP_STATUS_OK);
       } else {
         Log::error("Error while parsing input component");
         request->send(HTTP_STATUS_BAD_REQUEST);
       }
-      Card::releaseOutputJsonMemory();
-    } else request->send(HTTP_STATUS_OK_NO_CONTENT);
+    } else {
+      Metrics::markBusy(Metrics::Route::STATUS);
+      request->send(HTTP_STATUS_OK_NO_CONTENT);
+    }
+  });
+
+  webServer.on("/log", HTTP_GET, [] (AsyncWebServerRequest* request){
+    AsyncResponseStream* response = request->beginResponseStream("text/plain");
+    if(!Log::print(*response)) response->setCode(HTTP_STATUS_OK_NO_CONTENT);
+    request->send(response);
+  });
+
+  webServer.on("/metrics", HTTP_GET, [] (AsyncWebServerRequest* request){
+    AsyncResponseStream* response = request->beginResponseStream("text/plain; version=0.0.4");
+    Metrics::print(*response);
+    request->send(response);
   });
 }
 
@@ -1644,13 +4008,14 @@ void ServerInit(){
 
   HTTPServeWebsite(server);
   HTTPSetMappings(server);
+  HTTPSetEvents(server);
+  HTTPSetWebSocket(server);
   server.begin();
-  Log::errorStream.reserve(100);
 }
 }
 
 void setup(){
-  Serial.begin(9600);
+  Serial.begin(VISUINO_BAUD_RATE);
   if(!SPIFFS.begin()){
     Serial.println("An Error has occurred while mounting SPIFFS");
   }
@@ -1663,9 +4028,9 @@ void setup(){
   uint32_t before = millis();
   using namespace WebsiteServer;
   using namespace WebsiteServer::JsonReader;
-  InputJsonStatus status = readWebsiteComponentsFromJson(testWebsiteConfigStr);
-  testWebsiteConfigStr.clear();
+  InputJsonStatus status = Snapshot::bootLayout();
   Log::info(errorHandler(status));
+  memoryBudget();
   uint32_t after = millis();
   Serial.print("Execution time: ");
   Serial.println(after - before);
@@ -1674,7 +4039,9 @@ void setup(){
 
 
 void loop(){
-  WebsiteServer::JsonWriter::write();
-
+  uint32_t start = micros();
+  WebsiteServer::SerialOutput::service();
+  WebsiteServer::Events::publish();
+  WebsiteServer::Metrics::recordLoop(micros() - start);
 }
 